@@ -0,0 +1,858 @@
+// Benchmark suite: per-step, per-permutation, schedule derivation,
+// end-to-end hashing, XOF output, MAC and authenticated encryption costs.
+//
+// Every benchmark runs a callback for a calibrated number of iterations
+// (at least --min-time per run), repeats the run and reports the median run
+// per operation: nanoseconds, TSC cycles, cycles per byte, and - when the
+// kernel allows perf_event_open - retired instructions, cache misses and
+// branch misses. --json prints the same results as one JSON document for
+// tracking regressions between releases. The kernels are cross-checked
+// (cpu_dispatch_self_test) before anything is timed; set POLYMTD_ISA to
+// benchmark a narrower ISA than the CPU supports.
+//
+//   bench_polymtd [--json] [--max-size SIZE[K|M|G]] [--min-time MS] [--filter TEXT]
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // syscall(), clock_gettime under -std=c99
+#elif !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L // clock_gettime under -std=c99
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "cpu_dispatch.h"
+#include "keccak_engine.h"
+#include "keccak_sponge.h"
+#include "keccak_aead.h"
+#include "keccak_batch.h"
+#include "keccak_mac.h"
+#include "keccak_xof.h"
+#include "seed_batch.h"
+
+#define BENCH_RUNS        5
+#define BENCH_SCHEDULES   64          // random schedules cycled through
+#define BENCH_MAX_SIZE    (1ULL << 30)
+#define BENCH_RUN_BUDGET  2000000000ULL   // ns; fewer repeats past this
+
+// CLOCKS
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// TSC on x86; elsewhere cycles are reported as 0 and only ns are meaningful
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// HARDWARE COUNTERS
+
+#define COUNTER_INSTRUCTIONS 0
+#define COUNTER_CACHE_MISSES 1
+#define COUNTER_BRANCH_MISSES 2
+#define COUNTERS 3
+
+// One perf event per counter, user space only, this thread only.
+// A counter the kernel refuses (no PMU in a VM, perf_event_paranoid,
+// seccomp) stays at fd -1 and is reported as null.
+typedef struct {
+    int fd[COUNTERS];
+} PerfCounters;
+
+static void perf_open(PerfCounters *pc) {
+#ifdef __linux__
+    static const uint64_t config[COUNTERS] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int i = 0; i < COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        pc->fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#else
+    for (int i = 0; i < COUNTERS; i++) {
+        pc->fd[i] = -1;
+    }
+#endif
+}
+
+static void perf_close(PerfCounters *pc) {
+#ifdef __linux__
+    for (int i = 0; i < COUNTERS; i++) {
+        if (pc->fd[i] >= 0) {
+            close(pc->fd[i]);
+        }
+    }
+#else
+    (void)pc;
+#endif
+}
+
+static void perf_start(PerfCounters *pc) {
+#ifdef __linux__
+    for (int i = 0; i < COUNTERS; i++) {
+        if (pc->fd[i] >= 0) {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)pc;
+#endif
+}
+
+// Stop counting; values[i] is -1 for an unavailable counter
+static void perf_stop(PerfCounters *pc, double values[COUNTERS]) {
+    for (int i = 0; i < COUNTERS; i++) {
+        values[i] = -1;
+#ifdef __linux__
+        uint64_t count;
+        if (pc->fd[i] >= 0) {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(pc->fd[i], &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+                values[i] = (double)count;
+            }
+        }
+#endif
+    }
+}
+
+// BENCHMARK DRIVER
+
+typedef void (*bench_fn)(void *ctx, size_t iters);
+
+typedef struct {
+    int json;
+    int results;                // results printed so far
+    double min_time_ns;
+    uint64_t max_size;
+    const char *filter;
+    PerfCounters perf;
+} Bench;
+
+typedef struct {
+    double ns;
+    double cycles;
+    double counters[COUNTERS];
+} BenchRun;
+
+static int compare_runs(const void *a, const void *b) {
+    double x = ((const BenchRun*)a)->cycles, y = ((const BenchRun*)b)->cycles;
+    if (x == y) {
+        x = ((const BenchRun*)a)->ns;
+        y = ((const BenchRun*)b)->ns;
+    }
+    return (x > y) - (x < y);
+}
+
+static void bench_once(Bench *b, bench_fn fn, void *ctx, size_t iters, BenchRun *run) {
+    perf_start(&b->perf);
+    uint64_t t0 = now_ns();
+    uint64_t c0 = now_cycles();
+    fn(ctx, iters);
+    uint64_t c1 = now_cycles();
+    uint64_t t1 = now_ns();
+    perf_stop(&b->perf, run->counters);
+
+    run->ns = (double)(t1 - t0) / (double)iters;
+    run->cycles = (double)(c1 - c0) / (double)iters;
+    for (int i = 0; i < COUNTERS; i++) {
+        if (run->counters[i] >= 0) {
+            run->counters[i] /= (double)iters;
+        }
+    }
+}
+
+static void print_counter(const Bench *b, double value, int last) {
+    if (b->json) {
+        if (value < 0) {
+            printf("null");
+        } else {
+            printf("%.2f", value);
+        }
+        printf(last ? "}" : ", ");
+    } else if (value < 0) {
+        printf(" %12s", "-");
+    } else {
+        printf(" %12.1f", value);
+    }
+}
+
+// Time fn, bytes_per_op bytes per iteration (0 if not byte-oriented), and
+// print one result line or JSON object
+static void bench_run(Bench *b, const char *group, const char *name, size_t bytes_per_op,
+                      bench_fn fn, void *ctx) {
+    if (b->filter != NULL && strstr(name, b->filter) == NULL && strstr(group, b->filter) == NULL) {
+        return;
+    }
+
+    // Calibrate: double the iteration count until one run is long enough
+    BenchRun runs[BENCH_RUNS];
+    size_t iters = 1;
+    for (;;) {
+        bench_once(b, fn, ctx, iters, &runs[0]);
+        if (runs[0].ns * (double)iters >= b->min_time_ns) {
+            break;
+        }
+        double scale = runs[0].ns > 0 ? b->min_time_ns / (runs[0].ns * (double)iters) : 2.0;
+        iters = (size_t)((double)iters * (scale > 2.0 ? (scale < 100.0 ? scale * 1.2 : 100.0) : 2.0));
+    }
+
+    // Repeat while the total stays within budget (single run for huge inputs)
+    int count = 1;
+    while (count < BENCH_RUNS &&
+           runs[0].ns * (double)iters * (count + 1) < (double)BENCH_RUN_BUDGET) {
+        bench_once(b, fn, ctx, iters, &runs[count++]);
+    }
+    qsort(runs, (size_t)count, sizeof(runs[0]), compare_runs);
+    const BenchRun *m = &runs[count / 2];
+
+    double cpb = bytes_per_op ? m->cycles / (double)bytes_per_op : -1;
+    if (b->json) {
+        printf("%s    {\"group\": \"%s\", \"name\": \"%s\", \"bytes\": %zu, \"iterations\": %zu, "
+               "\"runs\": %d, \"ns_per_op\": %.2f, \"cycles_per_op\": %.2f, \"cycles_per_byte\": ",
+               b->results ? ",\n" : "", group, name, bytes_per_op, iters, count, m->ns, m->cycles);
+        if (cpb < 0) {
+            printf("null");
+        } else {
+            printf("%.4f", cpb);
+        }
+        printf(", \"instructions_per_op\": ");
+        print_counter(b, m->counters[COUNTER_INSTRUCTIONS], 0);
+        printf("\"cache_misses_per_op\": ");
+        print_counter(b, m->counters[COUNTER_CACHE_MISSES], 0);
+        printf("\"branch_misses_per_op\": ");
+        print_counter(b, m->counters[COUNTER_BRANCH_MISSES], 1);
+    } else {
+        printf("%-12s %-28s %14.1f %14.1f", group, name, m->ns, m->cycles);
+        if (cpb < 0) {
+            printf(" %10s", "-");
+        } else {
+            printf(" %10.3f", cpb);
+        }
+        for (int i = 0; i < COUNTERS; i++) {
+            print_counter(b, m->counters[i], i == COUNTERS - 1);
+        }
+        printf("\n");
+    }
+    b->results++;
+    fflush(stdout);
+}
+
+// STEP FUNCTIONS
+
+typedef struct {
+    keccak_step_fn step;
+    keccak_iota_fn iota;
+    u64 A[25];
+} StepCtx;
+
+static void run_step(void *p, size_t iters) {
+    StepCtx *c = (StepCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        c->step(c->A);
+    }
+}
+
+static void run_iota(void *p, size_t iters) {
+    StepCtx *c = (StepCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        c->iota(c->A, (int)(i % KECCAK_ROUNDS));
+    }
+}
+
+static void bench_steps(Bench *b) {
+    static const char *names[4] = {"theta", "rhopi", "chi", "iota"};
+    static const keccak_step_fn *tables[3] = {THETA_VARIANTS, RHOPI_VARIANTS, CHI_VARIANTS};
+    StepCtx ctx;
+    char name[32];
+
+    for (int i = 0; i < 25; i++) {
+        ctx.A[i] = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1);
+    }
+    for (int s = 0; s < 4; s++) {
+        for (int v = 0; v < KECCAK_VARIANTS; v++) {
+            snprintf(name, sizeof(name), "%s_v%d", names[s], v);
+            if (s < 3) {
+                ctx.step = tables[s][v];
+                bench_run(b, "step", name, sizeof(ctx.A), run_step, &ctx);
+            } else {
+                ctx.iota = IOTA_VARIANTS[v];
+                bench_run(b, "step", name, sizeof(ctx.A), run_iota, &ctx);
+            }
+        }
+    }
+}
+
+// PERMUTATIONS
+
+typedef struct {
+    KeccakSchedule schedules[BENCH_SCHEDULES];
+    PreparedSchedule prepared[BENCH_SCHEDULES];
+    PreparedSchedule fast[BENCH_SCHEDULES];     // KECCAK_ROUNDS_FAST rounds
+    PackedSchedule packed[BENCH_SCHEDULES];
+    u64 A[25];
+    u64 lanes[25 * 64];
+    const PreparedSchedule *divergent[64];
+    uint8_t seeds[BENCH_SCHEDULES][32];
+    uint8_t msg[64];
+} PermCtx;
+
+static void run_perm_prepared(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_prepared(c->A, &c->prepared[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_perm_fast(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_prepared(c->A, &c->fast[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_perm_schedule(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly(c->A, &c->schedules[i % BENCH_SCHEDULES]);
+    }
+}
+
+// 64 states under one schedule per iteration (MODE_KEY batches)
+static void run_perm_batch(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_batch(c->lanes, 64, &c->prepared[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_perm_batch_fast(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_batch(c->lanes, 64, &c->fast[i % BENCH_SCHEDULES]);
+    }
+}
+
+// 64 states with 64 different schedules per iteration (MODE_PLAINTEXT batches)
+static void run_perm_divergent(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_divergent(c->lanes, 64, c->divergent);
+    }
+}
+
+// Divergence sweep: 64 states over `distinct` schedules, state j under
+// schedule j % distinct, so equal schedules are spread across the batch
+typedef struct {
+    PermCtx *perm;
+    const PreparedSchedule *prepared[64];
+    const KeccakSchedule *schedules[64];
+} SweepCtx;
+
+static void run_sweep_divergent(void *p, size_t iters) {
+    SweepCtx *c = (SweepCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_divergent(c->perm->lanes, 64, c->prepared);
+    }
+}
+
+static void run_sweep_grouped(void *p, size_t iters) {
+    SweepCtx *c = (SweepCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_f_poly_grouped((u64 (*)[25])c->perm->lanes, c->schedules, 64);
+    }
+}
+
+// SCHEDULE DERIVATION
+
+static void run_sha256_seed(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        sha256(c->msg, sizeof(c->msg), c->seeds[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_sha256_batch(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    const uint8_t *msgs[16];
+    size_t lens[16];
+    for (int j = 0; j < 16; j++) {
+        msgs[j] = c->msg;
+        lens[j] = sizeof(c->msg);
+    }
+    for (size_t i = 0; i < iters; i++) {
+        sha256_batch(&SHA256_MIDSTATE_MSG, msgs, lens, 16, c->seeds);
+    }
+}
+
+static void run_aes_schedule(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        generate_schedule_internal(c->seeds[i % BENCH_SCHEDULES], &c->schedules[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_prepare(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_prepare_schedule(&c->schedules[i % BENCH_SCHEDULES], &c->prepared[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_prepare_packed(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_prepare_packed(&c->packed[i % BENCH_SCHEDULES], &c->prepared[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void run_derive_full(void *p, size_t iters) {
+    PermCtx *c = (PermCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        c->msg[0] = (uint8_t)i;
+        generate_schedule_from_binary(c->msg, sizeof(c->msg), &c->schedules[i % BENCH_SCHEDULES]);
+        keccak_prepare_schedule(&c->schedules[i % BENCH_SCHEDULES], &c->prepared[i % BENCH_SCHEDULES]);
+    }
+}
+
+static void bench_permutations(Bench *b) {
+    PermCtx *c = (PermCtx*)calloc(1, sizeof(PermCtx));
+    if (c == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < BENCH_SCHEDULES; i++) {
+        for (int j = 0; j < 32; j++) {
+            c->seeds[i][j] = (uint8_t)(i * 131 + j * 7 + 1);
+        }
+        generate_schedule_internal(c->seeds[i], &c->schedules[i]);
+        keccak_prepare_schedule(&c->schedules[i], &c->prepared[i]);
+        schedule_pack(&c->schedules[i], &c->packed[i]);
+        c->divergent[i] = &c->prepared[i];
+    }
+    for (int i = 0; i < BENCH_SCHEDULES; i++) {
+        KeccakSchedule fast = c->schedules[i];
+        schedule_set_rounds(&fast, KECCAK_ROUNDS_FAST);
+        keccak_prepare_schedule(&fast, &c->fast[i]);
+    }
+    for (int i = 0; i < 25 * 64; i++) {
+        c->lanes[i] = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1);
+    }
+    for (int i = 0; i < 64; i++) {
+        c->msg[i] = (uint8_t)i;
+    }
+
+    bench_run(b, "permutation", "prepared_random", sizeof(c->A), run_perm_prepared, c);
+    bench_run(b, "permutation", "schedule_random", sizeof(c->A), run_perm_schedule, c);
+    bench_run(b, "permutation", "batch64_shared", 64 * sizeof(c->A), run_perm_batch, c);
+    bench_run(b, "permutation", "batch64_divergent", 64 * sizeof(c->A), run_perm_divergent, c);
+    bench_run(b, "permutation", "prepared_random_r12", sizeof(c->A), run_perm_fast, c);
+    bench_run(b, "permutation", "batch64_shared_r12", 64 * sizeof(c->A), run_perm_batch_fast, c);
+
+    SweepCtx sweep;
+    sweep.perm = c;
+    for (int distinct = 1; distinct <= 64; distinct *= 2) {
+        char name[48];
+        for (int j = 0; j < 64; j++) {
+            sweep.prepared[j] = &c->prepared[j % distinct];
+            sweep.schedules[j] = &c->schedules[j % distinct];
+        }
+        snprintf(name, sizeof(name), "divergent_d%d", distinct);
+        bench_run(b, "divergence", name, 64 * sizeof(c->A), run_sweep_divergent, &sweep);
+        snprintf(name, sizeof(name), "grouped_d%d", distinct);
+        bench_run(b, "divergence", name, 64 * sizeof(c->A), run_sweep_grouped, &sweep);
+    }
+
+    bench_run(b, "schedule", "sha256_64B", sizeof(c->msg), run_sha256_seed, c);
+    bench_run(b, "schedule", "sha256_batch16_64B", 16 * sizeof(c->msg), run_sha256_batch, c);
+    bench_run(b, "schedule", "aes_ctr_schedule", 0, run_aes_schedule, c);
+    bench_run(b, "schedule", "prepare", 0, run_prepare, c);
+    bench_run(b, "schedule", "prepare_packed", 0, run_prepare_packed, c);
+    bench_run(b, "schedule", "derive_plaintext_64B", sizeof(c->msg), run_derive_full, c);
+
+    free(c);
+}
+
+// END-TO-END HASHING
+
+typedef struct {
+    const uint8_t *msg;
+    size_t len;
+    PreparedSchedule key;
+    uint8_t digest[32];
+} HashCtx;
+
+// MODE_PLAINTEXT: seed from the message, schedule, then the sponge pass
+static void run_hash_plaintext(void *p, size_t iters) {
+    HashCtx *c = (HashCtx*)p;
+    KeccakSchedule schedule;
+    for (size_t i = 0; i < iters; i++) {
+        generate_schedule_from_binary(c->msg, c->len, &schedule);
+        keccak_sponge_hash(&schedule, c->msg, c->len, c->digest, sizeof(c->digest));
+    }
+}
+
+// MODE_KEY: schedule prepared once, sponge pass only
+static void run_hash_keyed(void *p, size_t iters) {
+    HashCtx *c = (HashCtx*)p;
+    KeccakSponge sponge;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_sponge_init_prepared(&sponge, &c->key);
+        keccak_sponge_update(&sponge, c->msg, c->len);
+        keccak_sponge_squeeze(&sponge, c->digest, sizeof(c->digest));
+    }
+}
+
+static void bench_hashing(Bench *b) {
+    HashCtx ctx;
+    KeccakSchedule schedule;
+    char name[48];
+
+    uint64_t largest = 8;
+    while (largest * 8 <= b->max_size) {
+        largest *= 8;
+    }
+    uint8_t *msg = (uint8_t*)malloc((size_t)largest);
+    if (msg == NULL) {
+        fprintf(stderr, "bench_polymtd: cannot allocate %llu bytes\n", (unsigned long long)largest);
+        return;
+    }
+    uint64_t x = 0x243f6a8885a308d3ULL;
+    for (uint64_t i = 0; i < largest; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        msg[i] = (uint8_t)x;
+    }
+
+    generate_schedule_from_key("bench_polymtd", &schedule);
+    keccak_prepare_schedule(&schedule, &ctx.key);
+    ctx.msg = msg;
+
+    // 8 B, 64 B, 512 B, ... up to max_size (1 GiB by default)
+    for (uint64_t len = 8; len <= largest; len *= 8) {
+        ctx.len = (size_t)len;
+        snprintf(name, sizeof(name), "plaintext_%lluB", (unsigned long long)len);
+        bench_run(b, "hash", name, ctx.len, run_hash_plaintext, &ctx);
+        snprintf(name, sizeof(name), "keyed_%lluB", (unsigned long long)len);
+        bench_run(b, "hash", name, ctx.len, run_hash_keyed, &ctx);
+    }
+
+    free(msg);
+}
+
+// XOF OUTPUT
+
+#define BENCH_XOF_OUTPUT (64 << 10)
+
+typedef struct {
+    PreparedSchedule key;
+    KeccakXofCounter ctr;
+    uint8_t out[BENCH_XOF_OUTPUT];
+} XofCtx;
+
+// Sequential squeeze: one permutation per 136 bytes, one after another
+static void run_xof_sequential(void *p, size_t iters) {
+    XofCtx *c = (XofCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_xof(&c->key, c->out, 32, c->out, sizeof(c->out));
+    }
+}
+
+// Counter mode: independent blocks, 16 at a time on the batch kernels
+static void run_xof_counter(void *p, size_t iters) {
+    XofCtx *c = (XofCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_xof_counter_read(&c->ctr, (uint64_t)i * sizeof(c->out), c->out, sizeof(c->out),
+                                NULL);
+    }
+}
+
+static void bench_xof(Bench *b) {
+    XofCtx *c = (XofCtx*)calloc(1, sizeof(XofCtx));
+    KeccakSchedule schedule;
+    KeccakXof xof;
+
+    if (c == NULL) {
+        return;
+    }
+    generate_schedule_from_key("bench_polymtd", &schedule);
+    keccak_prepare_schedule(&schedule, &c->key);
+    keccak_xof_init(&xof, &c->key);
+    keccak_xof_update(&xof, (const uint8_t*)"bench_polymtd", 13);
+    keccak_xof_counter_init(&c->ctr, &xof);
+
+    bench_run(b, "xof", "sequential_64KiB", sizeof(c->out), run_xof_sequential, c);
+    bench_run(b, "xof", "counter_64KiB", sizeof(c->out), run_xof_counter, c);
+
+    free(c);
+}
+
+// MAC
+
+#define BENCH_MAC_KEY     "bench_polymtd"
+#define BENCH_MAC_BATCH   64
+
+typedef struct {
+    KeccakMac mac;
+    uint8_t msg[BENCH_MAC_BATCH][64];
+    const uint8_t *msgs[BENCH_MAC_BATCH];
+    size_t lens[BENCH_MAC_BATCH];
+    uint8_t tags[BENCH_MAC_BATCH][KECCAK_MAC_TAG];
+} MacCtx;
+
+// Without a snapshot: derive the key's schedule, then hash key || message
+static void run_mac_rekey(void *p, size_t iters) {
+    MacCtx *c = (MacCtx*)p;
+    KeccakSchedule schedule;
+    KeccakSponge sponge;
+    for (size_t i = 0; i < iters; i++) {
+        generate_schedule_from_key(BENCH_MAC_KEY, &schedule);
+        keccak_sponge_init(&sponge, &schedule);
+        keccak_sponge_update(&sponge, (const uint8_t*)BENCH_MAC_KEY, sizeof(BENCH_MAC_KEY) - 1);
+        keccak_sponge_update(&sponge, c->msg[0], sizeof(c->msg[0]));
+        keccak_sponge_squeeze(&sponge, c->tags[0], KECCAK_MAC_TAG);
+    }
+}
+
+// From the post-key snapshot: one permutation
+static void run_mac(void *p, size_t iters) {
+    MacCtx *c = (MacCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_mac(&c->mac, c->msg[0], sizeof(c->msg[0]), c->tags[0], KECCAK_MAC_TAG);
+    }
+}
+
+static void run_mac_batch(void *p, size_t iters) {
+    MacCtx *c = (MacCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_mac_batch(&c->mac, c->msgs, c->lens, BENCH_MAC_BATCH, c->tags);
+    }
+}
+
+static void bench_mac(Bench *b) {
+    MacCtx *c = (MacCtx*)calloc(1, sizeof(MacCtx));
+
+    if (c == NULL) {
+        return;
+    }
+    keccak_mac_init(&c->mac, BENCH_MAC_KEY, NULL);
+    for (int j = 0; j < BENCH_MAC_BATCH; j++) {
+        for (size_t i = 0; i < sizeof(c->msg[j]); i++) {
+            c->msg[j][i] = (uint8_t)(j * 64 + i);
+        }
+        c->msgs[j] = c->msg[j];
+        c->lens[j] = sizeof(c->msg[j]);
+    }
+
+    bench_run(b, "mac", "rekey_hash_64B", sizeof(c->msg[0]), run_mac_rekey, c);
+    bench_run(b, "mac", "snapshot_64B", sizeof(c->msg[0]), run_mac, c);
+    bench_run(b, "mac", "batch64_64B", sizeof(c->msg), run_mac_batch, c);
+
+    free(c);
+}
+
+// AUTHENTICATED ENCRYPTION
+
+#define BENCH_AEAD_MESSAGE (64 << 10)
+
+typedef struct {
+    PreparedSchedule key;
+    uint8_t nonce[KECCAK_AEAD_NONCE];
+    uint8_t aes_key[32];
+    uint8_t msg[BENCH_AEAD_MESSAGE];
+    uint8_t out[BENCH_AEAD_MESSAGE];
+    uint8_t tag[32];
+} AeadCtx;
+
+// Duplex AEAD: one pass, one permutation per 136 bytes
+static void run_aead_seal(void *p, size_t iters) {
+    AeadCtx *c = (AeadCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        c->nonce[0] = (uint8_t)i;
+        keccak_aead_seal(&c->key, "bench_polymtd", c->nonce, c->nonce, sizeof(c->nonce),
+                         c->msg, c->out, sizeof(c->msg), c->tag);
+    }
+}
+
+static void run_aead_open(void *p, size_t iters) {
+    AeadCtx *c = (AeadCtx*)p;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_aead_open(&c->key, "bench_polymtd", c->nonce, c->nonce, sizeof(c->nonce),
+                         c->out, c->msg, sizeof(c->msg), c->tag);
+    }
+}
+
+// The two-pass alternative: keyed polymorphic hash of the plaintext, then
+// AES-256-CTR over it
+static void run_hash_then_encrypt(void *p, size_t iters) {
+    AeadCtx *c = (AeadCtx*)p;
+    KeccakSponge sponge;
+    AES_CTR_PRNG prng;
+    for (size_t i = 0; i < iters; i++) {
+        keccak_sponge_init_prepared(&sponge, &c->key);
+        keccak_sponge_update(&sponge, c->msg, sizeof(c->msg));
+        keccak_sponge_squeeze(&sponge, c->tag, sizeof(c->tag));
+
+        c->aes_key[0] = (uint8_t)i;
+        aes_ctr_init(&prng, c->aes_key);
+        aes_ctr_fill(&prng, c->out, sizeof(c->out));
+        for (size_t j = 0; j < sizeof(c->out); j++) {
+            c->out[j] ^= c->msg[j];
+        }
+    }
+}
+
+static void bench_aead(Bench *b) {
+    AeadCtx *c = (AeadCtx*)calloc(1, sizeof(AeadCtx));
+    KeccakSchedule schedule;
+
+    if (c == NULL) {
+        return;
+    }
+    generate_schedule_from_key("bench_polymtd", &schedule);
+    keccak_prepare_schedule(&schedule, &c->key);
+    for (size_t i = 0; i < sizeof(c->msg); i++) {
+        c->msg[i] = (uint8_t)(i * 31 + 7);
+    }
+    // A valid tag for the open benchmark
+    keccak_aead_seal(&c->key, "bench_polymtd", c->nonce, c->nonce, sizeof(c->nonce),
+                     c->msg, c->out, sizeof(c->msg), c->tag);
+
+    bench_run(b, "aead", "open_64KiB", sizeof(c->msg), run_aead_open, c);
+    bench_run(b, "aead", "seal_64KiB", sizeof(c->msg), run_aead_seal, c);
+    bench_run(b, "aead", "hash_then_encrypt_64KiB", sizeof(c->msg), run_hash_then_encrypt, c);
+
+    free(c);
+}
+
+// MAIN
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    default: break;
+    }
+    return v;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--json] [--max-size SIZE[K|M|G]] [--min-time MS] [--filter TEXT]\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    Bench b;
+    memset(&b, 0, sizeof(b));
+    b.min_time_ns = 20e6;
+    b.max_size = BENCH_MAX_SIZE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            b.json = 1;
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            b.max_size = parse_size(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            b.min_time_ns = atof(argv[++i]) * 1e6;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            b.filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (b.max_size < 8) {
+        b.max_size = 8;
+    }
+
+    unsigned failing = 0;
+    if (cpu_dispatch_self_test(&failing) != 0) {
+        fprintf(stderr, "self-test failed for CPU features %#x\n", failing);
+        return 1;
+    }
+    unsigned features = cpu_features();
+
+    perf_open(&b.perf);
+
+#ifdef KECCAK_EQUALIZED
+    const int equalized = 1;
+#else
+    const int equalized = 0;
+#endif
+
+    if (b.json) {
+        printf("{\n  \"format\": 1,\n");
+#ifdef __VERSION__
+        printf("  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+        printf("  \"equalized\": %s,\n", equalized ? "true" : "false");
+        printf("  \"isa\": \"%s\",\n  \"cpu_features\": [", cpu_isa_name(features));
+        for (unsigned f = 1, first = 1; f <= features; f <<= 1) {
+            if (!(features & f)) continue;
+            printf("%s\"%s\"", first ? "" : ", ", cpu_feature_name(f));
+            first = 0;
+        }
+        printf("],\n");
+        printf("  \"sha_ni\": %s,\n", sha256_has_shani() ? "true" : "false");
+        printf("  \"sha256_batch_width\": %d,\n", sha256_batch_width());
+        printf("  \"keccak_batch_width\": %d,\n", keccak_batch_width());
+        printf("  \"perf_counters\": [%s, %s, %s],\n",
+               b.perf.fd[COUNTER_INSTRUCTIONS] >= 0 ? "true" : "false",
+               b.perf.fd[COUNTER_CACHE_MISSES] >= 0 ? "true" : "false",
+               b.perf.fd[COUNTER_BRANCH_MISSES] >= 0 ? "true" : "false");
+        printf("  \"results\": [\n");
+    } else {
+        printf("Build: %s, ISA %s, SHA-NI %s, SHA-256 batch width %d, Keccak batch width %d\n",
+               equalized ? "equalized" : "normal", cpu_isa_name(features),
+               sha256_has_shani() ? "yes" : "no",
+               sha256_batch_width(), keccak_batch_width());
+        printf("%-12s %-28s %14s %14s %10s %12s %12s %12s\n", "group", "name", "ns/op",
+               "cycles/op", "cyc/byte", "instr/op", "cmiss/op", "bmiss/op");
+    }
+
+    bench_steps(&b);
+    bench_permutations(&b);
+    bench_hashing(&b);
+    bench_xof(&b);
+    bench_mac(&b);
+    bench_aead(&b);
+
+    if (b.json) {
+        printf("\n  ]\n}\n");
+    }
+
+    perf_close(&b.perf);
+    return 0;
+}
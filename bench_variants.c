@@ -0,0 +1,141 @@
+// Per-variant cost of the permutation, for checking latency equalization.
+//
+// For every step and variant, times the 24-round permutation on a schedule
+// that uses that variant in every round and V0 for the other steps, in both
+// θ/ρπ orders, and prints the median cycles per permutation. The spread
+// column is (slowest - fastest) / fastest over the 7 variants of a step.
+// Build the library and this program with the same -DKECCAK_EQUALIZED
+// setting to compare the two modes.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "keccak_engine.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_now(void) {
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define BENCH_SAMPLES 2001
+#define BENCH_WARMUP  200
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Schedule with the same round in every position
+static void uniform_schedule(int order, const int variants[4], KeccakSchedule *schedule) {
+    memset(schedule, 0, sizeof(*schedule));
+    schedule->num_rounds = KECCAK_ROUNDS;
+    for (int r = 0; r < KECCAK_ROUNDS; r++) {
+        RoundSchedule *rs = &schedule->rounds[r];
+        rs->step_order[0] = order == 0 ? STEP_THETA : STEP_RHOPI;
+        rs->step_order[1] = order == 0 ? STEP_RHOPI : STEP_THETA;
+        rs->step_order[2] = STEP_CHI;
+        rs->step_order[3] = STEP_IOTA;
+        for (int i = 0; i < 4; i++) {
+            rs->variants[i] = variants[rs->step_order[i]];
+        }
+    }
+}
+
+// Median time of one permutation under each of the 7 prepared schedules.
+// Samples are taken round-robin over the schedules so that interference
+// from the rest of the machine is spread evenly across the variants.
+// Returns the XOR of the final state, which the caller prints so the
+// permutations cannot be discarded as dead code.
+static u64 time_variants(const PreparedSchedule prepared[KECCAK_VARIANTS],
+                          uint64_t median[KECCAK_VARIANTS]) {
+    static uint64_t samples[KECCAK_VARIANTS][BENCH_SAMPLES];
+    u64 A[25], sink = 0;
+
+    for (int i = 0; i < 25; i++) {
+        A[i] = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1);
+    }
+    for (int i = 0; i < BENCH_WARMUP; i++) {
+        for (int v = 0; v < KECCAK_VARIANTS; v++) {
+            keccak_f_poly_prepared(A, &prepared[v]);
+        }
+    }
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        for (int v = 0; v < KECCAK_VARIANTS; v++) {
+            uint64_t start = bench_now();
+            keccak_f_poly_prepared(A, &prepared[v]);
+            samples[v][i] = bench_now() - start;
+        }
+    }
+
+    for (int v = 0; v < KECCAK_VARIANTS; v++) {
+        qsort(samples[v], BENCH_SAMPLES, sizeof(samples[v][0]), compare_u64);
+        median[v] = samples[v][BENCH_SAMPLES / 2];
+    }
+    for (int i = 0; i < 25; i++) {
+        sink ^= A[i];
+    }
+    return sink;
+}
+
+int main(void) {
+    static const char *step_names[4] = {"theta", "rhopi", "chi", "iota"};
+    static const char *order_names[2] = {"th-first", "rp-first"};
+    u64 sink = 0;
+
+#ifdef KECCAK_EQUALIZED
+    printf("Build: equalized\n");
+#else
+    printf("Build: normal\n");
+#endif
+    printf("Median %s per 24-round permutation, other steps V0\n\n", BENCH_UNIT);
+    printf("%-6s %-9s", "step", "order");
+    for (int v = 0; v < KECCAK_VARIANTS; v++) {
+        printf(" %7s%d", "V", v);
+    }
+    printf("   spread\n");
+
+    for (int step = 0; step < 4; step++) {
+        for (int order = 0; order < 2; order++) {
+            PreparedSchedule prepared[KECCAK_VARIANTS];
+            uint64_t t[KECCAK_VARIANTS], lo = UINT64_MAX, hi = 0;
+
+            for (int v = 0; v < KECCAK_VARIANTS; v++) {
+                int variants[4] = {0, 0, 0, 0};
+                KeccakSchedule schedule;
+
+                variants[step] = v;
+                uniform_schedule(order, variants, &schedule);
+                keccak_prepare_schedule(&schedule, &prepared[v]);
+            }
+            sink ^= time_variants(prepared, t);
+
+            for (int v = 0; v < KECCAK_VARIANTS; v++) {
+                lo = t[v] < lo ? t[v] : lo;
+                hi = t[v] > hi ? t[v] : hi;
+            }
+
+            printf("%-6s %-9s", step_names[step], order_names[order]);
+            for (int v = 0; v < KECCAK_VARIANTS; v++) {
+                printf(" %8llu", (unsigned long long)t[v]);
+            }
+            printf("   %5.1f%%\n", 100.0 * (double)(hi - lo) / (double)lo);
+        }
+    }
+    printf("\nstate checksum %016llx\n", (unsigned long long)sink);
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu_dispatch.h"
+#include "keccak_batch.h"
+#include "keccak_static.h"
+#include "seed_batch.h"
+
+// FEATURE DETECTION
+
+// cpu_state holds the enabled features plus CPU_READY once probed. Probing
+// is idempotent, so threads racing through the first call all store the
+// same value and no lock is needed.
+#define CPU_READY 0x80000000u
+
+static unsigned cpu_state;
+static unsigned cpu_detected;
+
+static unsigned cpu_probe(void) {
+    unsigned features = 0;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#if defined(CPU_MULTI_ISA) || defined(__AVX2__)
+    if (__builtin_cpu_supports("avx2")) features |= CPU_AVX2;
+#endif
+#if defined(CPU_MULTI_ISA) || defined(__AVX512F__)
+    if (__builtin_cpu_supports("avx512f")) features |= CPU_AVX512;
+#endif
+    if (__builtin_cpu_supports("sha")) features |= CPU_SHANI;
+    if (__builtin_cpu_supports("aes")) features |= CPU_AESNI;
+    if (__builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f")) {
+        features |= CPU_VAES;
+    }
+#endif
+    return features;
+}
+
+// Feature cap requested through CPU_ISA_ENV
+static unsigned cpu_env_cap(void) {
+    const char *isa = getenv(CPU_ISA_ENV);
+
+    if (!isa) return ~0u;
+    if (strcmp(isa, "scalar") == 0) return 0;
+    if (strcmp(isa, "avx2") == 0) return CPU_AVX2 | CPU_SHANI | CPU_AESNI;
+    return ~0u;  // "avx512", "auto" or unrecognized
+}
+
+static unsigned cpu_init(void) {
+    unsigned detected = cpu_probe();
+    unsigned state = CPU_READY | (detected & cpu_env_cap());
+
+    __atomic_store_n(&cpu_detected, detected, __ATOMIC_RELAXED);
+    __atomic_store_n(&cpu_state, state, __ATOMIC_RELEASE);
+    return state;
+}
+
+unsigned cpu_features(void) {
+    unsigned state = __atomic_load_n(&cpu_state, __ATOMIC_ACQUIRE);
+
+    if (!(state & CPU_READY)) state = cpu_init();
+    return state & ~CPU_READY;
+}
+
+unsigned cpu_features_detected(void) {
+    cpu_features();
+    return __atomic_load_n(&cpu_detected, __ATOMIC_RELAXED);
+}
+
+unsigned cpu_features_select(unsigned features) {
+    unsigned enabled = features & cpu_features_detected();
+
+    __atomic_store_n(&cpu_state, CPU_READY | enabled, __ATOMIC_RELEASE);
+    return enabled;
+}
+
+const char *cpu_isa_name(unsigned features) {
+    if (features & CPU_AVX512) return "avx512";
+    if (features & CPU_AVX2) return "avx2";
+    return "scalar";
+}
+
+const char *cpu_feature_name(unsigned feature) {
+    switch (feature) {
+    case CPU_AVX2: return "avx2";
+    case CPU_AVX512: return "avx512f";
+    case CPU_SHANI: return "sha";
+    case CPU_AESNI: return "aes";
+    case CPU_VAES: return "vaes";
+    default: return "unknown";
+    }
+}
+
+// SELF-TEST
+
+// 13 states cover an 8-wide group, a 4-wide group and a scalar tail;
+// 37 messages keep every SHA-256 lane refilling at different times
+#define TEST_STATES   13
+#define TEST_MESSAGES 37
+#define TEST_DATA     4096
+#define TEST_AES      1007
+
+// print_schedule_static() of the schedule of TEST_STATIC_KEY: every variant
+// of every step and both orders occur
+#define TEST_STATIC_KEY "PolyMTD static self-test"
+#define KECCAK_SCHEDULE_SELF_TEST(ROUND) \
+    ROUND( 0, 0, 5, 6, 3, 3) \
+    ROUND( 1, 0, 5, 2, 1, 6) \
+    ROUND( 2, 0, 2, 4, 4, 6) \
+    ROUND( 3, 1, 5, 5, 4, 6) \
+    ROUND( 4, 1, 1, 6, 0, 4) \
+    ROUND( 5, 1, 3, 6, 2, 6) \
+    ROUND( 6, 0, 0, 3, 2, 2) \
+    ROUND( 7, 1, 3, 0, 0, 4) \
+    ROUND( 8, 0, 4, 6, 0, 0) \
+    ROUND( 9, 1, 3, 1, 1, 4) \
+    ROUND(10, 0, 4, 6, 0, 5) \
+    ROUND(11, 1, 5, 2, 6, 2) \
+    ROUND(12, 1, 3, 1, 2, 0) \
+    ROUND(13, 1, 1, 3, 3, 3) \
+    ROUND(14, 0, 6, 2, 1, 6) \
+    ROUND(15, 0, 1, 4, 2, 2) \
+    ROUND(16, 1, 6, 5, 3, 5) \
+    ROUND(17, 0, 0, 2, 5, 0) \
+    ROUND(18, 0, 1, 1, 1, 5) \
+    ROUND(19, 1, 6, 4, 6, 4) \
+    ROUND(20, 0, 0, 6, 5, 3) \
+    ROUND(21, 0, 0, 6, 6, 5) \
+    ROUND(22, 1, 1, 2, 3, 0) \
+    ROUND(23, 1, 3, 4, 0, 0)
+
+KECCAK_DEFINE_STATIC_PERMUTATION(static_canonical, KECCAK_SCHEDULE_CANONICAL)
+KECCAK_DEFINE_STATIC_PERMUTATION(static_canonical_fast, KECCAK_SCHEDULE_CANONICAL_FAST)
+KECCAK_DEFINE_STATIC_PERMUTATION(static_keyed, KECCAK_SCHEDULE_SELF_TEST)
+
+typedef struct {
+    u64 batch[25 * TEST_STATES];
+    u64 fast[25 * TEST_STATES];
+    u64 divergent[25 * TEST_STATES];
+    uint8_t sha_batch[TEST_MESSAGES][32];
+    uint8_t sha[32];
+    uint8_t aes[TEST_AES];
+} SelfTestOutput;
+
+typedef struct {
+    uint8_t data[TEST_DATA];
+    u64 lanes[25 * TEST_STATES];
+    PreparedSchedule prepared[3];
+    const uint8_t *msgs[TEST_MESSAGES];
+    size_t lens[TEST_MESSAGES];
+} SelfTestInput;
+
+static u64 splitmix64(u64 *x) {
+    u64 z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Inputs are derived on the portable code path. The second schedule differs
+// from the first in two rounds only (a χ variant and the θ/ρπ order). The
+// third is the second cut to KECCAK_ROUNDS_FAST rounds.
+static void self_test_input(SelfTestInput *in) {
+    KeccakSchedule schedule;
+    u64 x = 0x504f4c594d5444ULL;
+
+    for (size_t i = 0; i < TEST_DATA; i++) {
+        in->data[i] = (uint8_t)splitmix64(&x);
+    }
+    for (int i = 0; i < 25 * TEST_STATES; i++) {
+        in->lanes[i] = splitmix64(&x);
+    }
+
+    generate_schedule_from_binary(in->data, 64, &schedule);
+    keccak_prepare_schedule(&schedule, &in->prepared[0]);
+    schedule.rounds[5].variants[2] = (schedule.rounds[5].variants[2] + 1) % KECCAK_VARIANTS;
+    for (int i = 0; i < 2; i++) {
+        int s = schedule.rounds[9].step_order[i];
+        schedule.rounds[9].step_order[i] = s == STEP_THETA ? STEP_RHOPI :
+                                           s == STEP_RHOPI ? STEP_THETA : s;
+    }
+    keccak_prepare_schedule(&schedule, &in->prepared[1]);
+    schedule_set_rounds(&schedule, KECCAK_ROUNDS_FAST);
+    keccak_prepare_schedule(&schedule, &in->prepared[2]);
+
+    for (int j = 0; j < TEST_MESSAGES; j++) {
+        in->lens[j] = (size_t)(j * 37) % 300;
+        in->msgs[j] = in->data + j * 64;
+    }
+}
+
+// Compile-time permutations (keccak_static.h) against the prepared engine
+// on the same schedules. Returns 0 if they all match.
+static int self_test_static(const SelfTestInput *in) {
+    static void (*const permutations[3])(u64 A[25]) = {
+        static_canonical, static_canonical_fast, static_keyed
+    };
+    KeccakSchedule schedules[3];
+    int bad = 0;
+
+    memset(&schedules[0], 0, sizeof(schedules[0]));
+    schedules[0].num_rounds = KECCAK_ROUNDS_FULL;
+    for (int r = 0; r < KECCAK_ROUNDS_FULL; r++) {
+        for (int i = 0; i < 4; i++) {
+            schedules[0].rounds[r].step_order[i] = i;
+        }
+    }
+    schedules[1] = schedules[0];
+    schedule_set_rounds(&schedules[1], KECCAK_ROUNDS_FAST);
+    generate_schedule_from_key(TEST_STATIC_KEY, &schedules[2]);
+
+    for (int k = 0; k < 3; k++) {
+        PreparedSchedule prepared;
+        u64 expected[25], got[25];
+
+        memcpy(expected, in->lanes, sizeof(expected));
+        memcpy(got, in->lanes, sizeof(got));
+        keccak_prepare_schedule(&schedules[k], &prepared);
+        keccak_f_poly_prepared(expected, &prepared);
+        permutations[k](got);
+        bad |= memcmp(expected, got, sizeof(got)) != 0;
+    }
+    return bad ? -1 : 0;
+}
+
+static void self_test_run(const SelfTestInput *in, SelfTestOutput *out) {
+    const PreparedSchedule *mixed[TEST_STATES];
+    AES_CTR_PRNG prng;
+
+    memcpy(out->batch, in->lanes, sizeof(out->batch));
+    keccak_f_poly_batch(out->batch, TEST_STATES, &in->prepared[0]);
+    memcpy(out->fast, in->lanes, sizeof(out->fast));
+    keccak_f_poly_batch(out->fast, TEST_STATES, &in->prepared[2]);
+
+    // States 0-7 share the first schedule and 8-11 the second, so groups of
+    // either width run in lockstep; state 12 is the scalar tail
+    for (int j = 0; j < TEST_STATES; j++) {
+        mixed[j] = &in->prepared[j >= 8 && j < 12];
+    }
+    memcpy(out->divergent, in->lanes, sizeof(out->divergent));
+    keccak_f_poly_divergent(out->divergent, TEST_STATES, mixed);
+
+    sha256_batch(&SHA256_MIDSTATE_MSG, in->msgs, in->lens, TEST_MESSAGES, out->sha_batch);
+    sha256(in->data, 1000, out->sha);
+
+    // A partial block first, so the bulk path starts mid-stream
+    aes_ctr_init(&prng, in->data);
+    aes_ctr_fill(&prng, out->aes, 7);
+    aes_ctr_fill(&prng, out->aes + 7, TEST_AES - 7);
+}
+
+int cpu_dispatch_self_test(unsigned *failing) {
+    unsigned previous = cpu_features();
+    unsigned detected = cpu_features_detected();
+    SelfTestInput *in = (SelfTestInput*)malloc(sizeof(SelfTestInput));
+    SelfTestOutput *ref = (SelfTestOutput*)malloc(sizeof(SelfTestOutput));
+    SelfTestOutput *got = (SelfTestOutput*)malloc(sizeof(SelfTestOutput));
+    int result = 0;
+
+    if (!in || !ref || !got) {
+        free(in);
+        free(ref);
+        free(got);
+        return -1;
+    }
+
+    cpu_features_select(0);
+    self_test_input(in);
+    self_test_run(in, ref);
+    if (self_test_static(in) != 0) {
+        if (failing) *failing = 0;
+        result = -1;
+    }
+
+    // Every subset of the detected features is a configuration some CPU
+    // (or CPU_ISA_ENV setting) can end up with
+    for (unsigned features = 1; result == 0 && features <= detected; features++) {
+        if (features & ~detected) continue;
+
+        cpu_features_select(features);
+        self_test_run(in, got);
+        if (memcmp(ref, got, sizeof(*ref)) != 0) {
+            if (failing) *failing = features;
+            result = -1;
+            break;
+        }
+    }
+
+    cpu_features_select(previous);
+    free(in);
+    free(ref);
+    free(got);
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Run-time selection of the ISA-specific kernels. One library build carries
+// the portable C code plus AVX2 and AVX-512 versions of the Keccak batch
+// kernels and the SHA-256 multi-buffer kernels, and SHA-NI / AES-NI / VAES
+// versions of single-stream SHA-256 and AES-CTR. The CPU is probed once, on
+// first use; every dispatching function then reads the enabled feature set.
+
+// Feature bits
+#define CPU_AVX2   0x01u    // 4-way Keccak, 8-way SHA-256
+#define CPU_AVX512 0x02u    // 8-way Keccak, 16-way SHA-256 (AVX-512F)
+#define CPU_SHANI  0x04u    // single-stream SHA-256
+#define CPU_AESNI  0x08u    // AES-CTR, 8 blocks in flight
+#define CPU_VAES   0x10u    // AES-CTR, 16 blocks in flight (with AVX-512F)
+
+// Environment variable capping the features used by the process:
+// "scalar" (portable C only), "avx2" (AVX2 plus the 128-bit SHA/AES
+// extensions), "avx512" or "auto" (everything the CPU has, the default).
+// Unrecognized values are ignored. Features the CPU lacks are never enabled.
+#define CPU_ISA_ENV "POLYMTD_ISA"
+
+// GCC on x86 compiles the vector kernels for their ISA with target pragmas,
+// whatever -m flags the build uses. Other compilers only get the kernels
+// their build flags enable (e.g. -mavx2), as before.
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_MULTI_ISA 1
+#define CPU_PRAGMA(x) _Pragma(#x)
+#define CPU_TARGET_BEGIN(isa) CPU_PRAGMA(GCC push_options) CPU_PRAGMA(GCC target(isa))
+#define CPU_TARGET_END CPU_PRAGMA(GCC pop_options)
+#else
+#define CPU_TARGET_BEGIN(isa)
+#define CPU_TARGET_END
+#endif
+
+// Features of this CPU that the build has kernels for
+unsigned cpu_features_detected(void);
+
+// Features in use (detected, capped by CPU_ISA_ENV or cpu_features_select)
+unsigned cpu_features(void);
+
+// Use only `features` from now on (intersected with the detected set) and
+// return the resulting set. Meant for tests and benchmarks: no hashing may
+// be in progress on other threads while the selection changes.
+unsigned cpu_features_select(unsigned features);
+
+// Name of the widest vector tier in a feature set: "avx512", "avx2" or "scalar"
+const char *cpu_isa_name(unsigned features);
+
+// Name of a single feature bit ("avx2", "avx512f", "sha", "aes", "vaes")
+const char *cpu_feature_name(unsigned feature);
+
+// Cross-check every combination of the detected features against the
+// portable C code: batch (full and reduced-round) and divergent
+// permutations, multi-buffer and single-stream SHA-256, and AES-CTR
+// keystream. Restores the previous selection. Returns 0 if all outputs
+// match, -1 otherwise; the first failing feature set is stored in *failing
+// when it is not NULL. Same threading rule as cpu_features_select. The
+// compile-time permutations of keccak_static.h (canonical, 12-round and one
+// keyed schedule) are checked against the prepared engine first; a
+// mismatch there fails with set 0.
+int cpu_dispatch_self_test(unsigned *failing);
+
+#endif // CPU_DISPATCH_H
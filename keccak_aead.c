@@ -0,0 +1,214 @@
+#include <string.h>
+
+#include "keccak_aead.h"
+
+// Phases of a message
+#define AEAD_AD       0
+#define AEAD_MESSAGE  1
+#define AEAD_FINISHED 2
+
+static inline void xor_byte(u64 state[25], size_t pos, uint8_t b) {
+    state[pos / 8] ^= (u64)b << (8 * (pos % 8));
+}
+
+static inline uint8_t get_byte(const u64 state[25], size_t pos) {
+    return (uint8_t)(state[pos / 8] >> (8 * (pos % 8)));
+}
+
+// INITIALIZATION
+
+void keccak_aead_init_prepared(KeccakAead *ctx, const PreparedSchedule *prepared,
+                               const char *key, const uint8_t nonce[KECCAK_AEAD_NONCE]) {
+    KeccakSponge init;
+    size_t key_len = strlen(key);
+    uint8_t encoded_len[8];
+
+    // S = sponge(le64(|K|) || K || N); the length keeps K and N apart
+    store64_le(encoded_len, (u64)key_len);
+    keccak_sponge_init_prepared(&init, prepared);
+    keccak_sponge_update(&init, encoded_len, sizeof(encoded_len));
+    keccak_sponge_update(&init, (const uint8_t*)key, key_len);
+    keccak_sponge_update(&init, nonce, KECCAK_AEAD_NONCE);
+    keccak_sponge_final_pad(&init, KECCAK_AEAD_PAD_INIT);
+
+    memcpy(ctx->state, init.state, sizeof(ctx->state));
+    ctx->prepared = *prepared;
+    ctx->pos = 0;
+    ctx->phase = AEAD_AD;
+    ctx->has_ad = 0;
+}
+
+int keccak_aead_init(KeccakAead *ctx, const char *key, const uint8_t nonce[KECCAK_AEAD_NONCE]) {
+    KeccakSchedule schedule;
+    PreparedSchedule prepared;
+
+    generate_schedule_from_key(key, &schedule);
+    if (keccak_prepare_schedule(&schedule, &prepared) != 0) {
+        return -1;
+    }
+    keccak_aead_init_prepared(ctx, &prepared, key, nonce);
+    return 0;
+}
+
+// ASSOCIATED DATA
+
+int keccak_aead_update_ad(KeccakAead *ctx, const uint8_t *ad, size_t len) {
+    if (ctx->phase != AEAD_AD) {
+        return -1;
+    }
+    if (len > 0) {
+        ctx->has_ad = 1;
+    }
+
+    while (len > 0) {
+        // Whole blocks straight from the caller's buffer
+        if (ctx->pos == 0 && len >= KECCAK_SPONGE_RATE) {
+            for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+                ctx->state[i] ^= load64_le(ad + 8 * i);
+            }
+            keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+            ad += KECCAK_SPONGE_RATE;
+            len -= KECCAK_SPONGE_RATE;
+            continue;
+        }
+
+        xor_byte(ctx->state, ctx->pos++, *ad++);
+        len--;
+        if (ctx->pos == KECCAK_SPONGE_RATE) {
+            keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+            ctx->pos = 0;
+        }
+    }
+    return 0;
+}
+
+// Close the associated data (when there was any) and switch to the message
+static void start_message(KeccakAead *ctx) {
+    if (ctx->has_ad) {
+        xor_byte(ctx->state, ctx->pos, 0x01);
+        xor_byte(ctx->state, KECCAK_SPONGE_RATE - 1, 0x80);
+        keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+    }
+    ctx->state[24] ^= KECCAK_AEAD_DOMAIN_DATA;
+    ctx->pos = 0;
+    ctx->phase = AEAD_MESSAGE;
+}
+
+// MESSAGE
+
+// The rate always ends up holding the ciphertext: encryption XORs the
+// plaintext in and outputs the result, decryption outputs input XOR rate
+// and stores the input.
+static int aead_crypt(KeccakAead *ctx, const uint8_t *in, uint8_t *out, size_t len,
+                      int decrypt) {
+    if (ctx->phase == AEAD_FINISHED) {
+        return -1;
+    }
+    if (ctx->phase == AEAD_AD) {
+        start_message(ctx);
+    }
+
+    while (len > 0) {
+        // Whole blocks lane by lane; in == out works as each lane is
+        // loaded before it is stored
+        if (ctx->pos == 0 && len >= KECCAK_SPONGE_RATE) {
+            for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+                u64 x = load64_le(in + 8 * i);
+                store64_le(out + 8 * i, x ^ ctx->state[i]);
+                ctx->state[i] = decrypt ? x : x ^ ctx->state[i];
+            }
+            keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+            in += KECCAK_SPONGE_RATE;
+            out += KECCAK_SPONGE_RATE;
+            len -= KECCAK_SPONGE_RATE;
+            continue;
+        }
+
+        uint8_t x = *in++;
+        uint8_t y = (uint8_t)(x ^ get_byte(ctx->state, ctx->pos));
+        xor_byte(ctx->state, ctx->pos++, decrypt ? y : x);
+        *out++ = y;
+        len--;
+        if (ctx->pos == KECCAK_SPONGE_RATE) {
+            keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+            ctx->pos = 0;
+        }
+    }
+    return 0;
+}
+
+int keccak_aead_encrypt(KeccakAead *ctx, const uint8_t *in, uint8_t *out, size_t len) {
+    return aead_crypt(ctx, in, out, len, 0);
+}
+
+int keccak_aead_decrypt(KeccakAead *ctx, const uint8_t *in, uint8_t *out, size_t len) {
+    return aead_crypt(ctx, in, out, len, 1);
+}
+
+// TAG
+
+static int compute_tag(KeccakAead *ctx, uint8_t tag[KECCAK_AEAD_TAG]) {
+    if (ctx->phase == AEAD_FINISHED) {
+        return -1;
+    }
+    if (ctx->phase == AEAD_AD) {
+        start_message(ctx);
+    }
+
+    xor_byte(ctx->state, ctx->pos, 0x01);
+    xor_byte(ctx->state, KECCAK_SPONGE_RATE - 1, 0x80);
+    ctx->state[24] ^= KECCAK_AEAD_DOMAIN_FINAL;
+    keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+
+    for (int i = 0; i < KECCAK_AEAD_TAG; i++) {
+        tag[i] = get_byte(ctx->state, (size_t)i);
+    }
+    ctx->phase = AEAD_FINISHED;
+    return 0;
+}
+
+int keccak_aead_final(KeccakAead *ctx, uint8_t tag[KECCAK_AEAD_TAG]) {
+    return compute_tag(ctx, tag);
+}
+
+int keccak_aead_verify(KeccakAead *ctx, const uint8_t tag[KECCAK_AEAD_TAG]) {
+    uint8_t expected[KECCAK_AEAD_TAG];
+    uint8_t diff = 0;
+
+    if (compute_tag(ctx, expected) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < KECCAK_AEAD_TAG; i++) {
+        diff |= (uint8_t)(expected[i] ^ tag[i]);
+    }
+    return diff == 0 ? 0 : -1;
+}
+
+// ONE-SHOT
+
+void keccak_aead_seal(const PreparedSchedule *prepared, const char *key,
+                      const uint8_t nonce[KECCAK_AEAD_NONCE], const uint8_t *ad, size_t ad_len,
+                      const uint8_t *in, uint8_t *out, size_t len, uint8_t tag[KECCAK_AEAD_TAG]) {
+    KeccakAead ctx;
+
+    keccak_aead_init_prepared(&ctx, prepared, key, nonce);
+    keccak_aead_update_ad(&ctx, ad, ad_len);
+    keccak_aead_encrypt(&ctx, in, out, len);
+    keccak_aead_final(&ctx, tag);
+}
+
+int keccak_aead_open(const PreparedSchedule *prepared, const char *key,
+                     const uint8_t nonce[KECCAK_AEAD_NONCE], const uint8_t *ad, size_t ad_len,
+                     const uint8_t *in, uint8_t *out, size_t len,
+                     const uint8_t tag[KECCAK_AEAD_TAG]) {
+    KeccakAead ctx;
+
+    keccak_aead_init_prepared(&ctx, prepared, key, nonce);
+    keccak_aead_update_ad(&ctx, ad, ad_len);
+    keccak_aead_decrypt(&ctx, in, out, len);
+    if (keccak_aead_verify(&ctx, tag) != 0) {
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
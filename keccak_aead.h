@@ -0,0 +1,86 @@
+#ifndef KECCAK_AEAD_H
+#define KECCAK_AEAD_H
+
+#include <stddef.h>
+#include "keccak_sponge.h"
+
+// Authenticated encryption in one pass, on a keyed duplex over the
+// polymorphic permutation (rate 136, capacity 64 bytes).
+//
+// The schedule is the keyed-mode schedule of the key
+// (generate_schedule_from_key), so it can be prepared once per key. Every
+// message then starts from
+//     S = sponge(le64(|K|) || K || N)      with KECCAK_AEAD_PAD_INIT
+// so the key is in the state as well as in the schedule, and the nonce N
+// makes S unique per message. Then, 136 bytes per permutation:
+//   - associated data, if any, is absorbed block by block and closed with
+//     pad10*1 and a permutation;
+//   - lane 24 (capacity) gets KECCAK_AEAD_DOMAIN_DATA;
+//   - each plaintext block is XORed into the rate, which becomes the
+//     ciphertext block, then the state is permuted;
+//   - the last (possibly empty) block is closed with pad10*1, lane 24 gets
+//     KECCAK_AEAD_DOMAIN_FINAL and after one more permutation the tag is
+//     the first KECCAK_AEAD_TAG bytes of the rate.
+// Encryption and authentication share every permutation, so each byte is
+// read once. A nonce must never be reused under the same key.
+
+#define KECCAK_AEAD_NONCE 16
+#define KECCAK_AEAD_TAG   16
+
+// Domain bits '10' of the initialization sponge (see KECCAK_SPONGE_PAD)
+#define KECCAK_AEAD_PAD_INIT 0x05
+
+// Bits XORed into capacity lane 24 between phases
+#define KECCAK_AEAD_DOMAIN_DATA  ((u64)1 << 63)
+#define KECCAK_AEAD_DOMAIN_FINAL ((u64)1 << 62)
+
+// Streaming context. Associated data must all come before the first byte
+// of the message; encrypt and decrypt accept any split.
+typedef struct {
+    u64 state[25];
+    PreparedSchedule prepared;
+    size_t pos;          // bytes of the current rate block used
+    int phase;           // associated data, message or finished
+    int has_ad;          // some associated data has been absorbed
+} KeccakAead;
+
+// Start a message under the prepared keyed-mode schedule of key (from
+// generate_schedule_from_key) and a nonce.
+void keccak_aead_init_prepared(KeccakAead *ctx, const PreparedSchedule *prepared,
+                               const char *key, const uint8_t nonce[KECCAK_AEAD_NONCE]);
+
+// Same, deriving the schedule from key first (costs a schedule derivation
+// per message; prefer keccak_aead_init_prepared for many messages).
+// Returns 0, or -1 if the derived schedule is invalid.
+int keccak_aead_init(KeccakAead *ctx, const char *key, const uint8_t nonce[KECCAK_AEAD_NONCE]);
+
+// Absorb associated data; may be called any number of times.
+// Returns 0, or -1 once the message has started.
+int keccak_aead_update_ad(KeccakAead *ctx, const uint8_t *ad, size_t len);
+
+// Encrypt or decrypt len bytes from in to out (in == out is allowed).
+// Returns 0, or -1 once the tag has been produced or checked.
+int keccak_aead_encrypt(KeccakAead *ctx, const uint8_t *in, uint8_t *out, size_t len);
+int keccak_aead_decrypt(KeccakAead *ctx, const uint8_t *in, uint8_t *out, size_t len);
+
+// Finish an encryption and write the tag. Returns 0, or -1 if already finished.
+int keccak_aead_final(KeccakAead *ctx, uint8_t tag[KECCAK_AEAD_TAG]);
+
+// Finish a decryption and compare the tag in constant time. Returns 0 if
+// the tag is valid, -1 otherwise. Streamed plaintext is unauthenticated
+// until this returns 0; keccak_aead_open withholds it instead.
+int keccak_aead_verify(KeccakAead *ctx, const uint8_t tag[KECCAK_AEAD_TAG]);
+
+// One-shot encryption of len bytes
+void keccak_aead_seal(const PreparedSchedule *prepared, const char *key,
+                      const uint8_t nonce[KECCAK_AEAD_NONCE], const uint8_t *ad, size_t ad_len,
+                      const uint8_t *in, uint8_t *out, size_t len, uint8_t tag[KECCAK_AEAD_TAG]);
+
+// One-shot decryption. Returns 0 if the tag is valid, -1 otherwise; on
+// failure out is zeroed.
+int keccak_aead_open(const PreparedSchedule *prepared, const char *key,
+                     const uint8_t nonce[KECCAK_AEAD_NONCE], const uint8_t *ad, size_t ad_len,
+                     const uint8_t *in, uint8_t *out, size_t len,
+                     const uint8_t tag[KECCAK_AEAD_TAG]);
+
+#endif // KECCAK_AEAD_H
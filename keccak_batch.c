@@ -0,0 +1,381 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "keccak_batch.h"
+#include "keccak_stats.h"
+#include "keccak_variants_impl.h"
+#include "cpu_dispatch.h"
+
+// SIMD LANE TYPES
+
+// Vector kernels are instantiated from keccak_variants_body.h with GCC/Clang
+// vector types, so every variant gets a 4-way (AVX2) and 8-way (AVX-512)
+// version from the same source as the scalar one. With CPU_MULTI_ISA they
+// are compiled for their ISA inside CPU_TARGET_BEGIN/END regions and picked
+// at run time; otherwise only when the build enables the ISA (e.g. -mavx2).
+
+#if defined(__GNUC__) && (defined(__AVX512F__) || defined(CPU_MULTI_ISA))
+#define KECCAK_BATCH_X8 1
+CPU_TARGET_BEGIN("avx512f")
+
+typedef u64 lane_x8 __attribute__((vector_size(64)));
+
+static inline lane_x8 rol64_x8(lane_x8 x, int n) {
+    return (x << n) | (x >> ((64 - n) & 63));
+}
+
+#define KECCAK_LANE lane_x8
+#define KECCAK_ROL rol64_x8
+#define KECCAK_FN(name) name##_x8
+#include "keccak_variants_body.h"
+CPU_TARGET_END
+#endif
+
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(CPU_MULTI_ISA))
+#define KECCAK_BATCH_X4 1
+CPU_TARGET_BEGIN("avx2")
+
+typedef u64 lane_x4 __attribute__((vector_size(32)));
+
+static inline lane_x4 rol64_x4(lane_x4 x, int n) {
+    return (x << n) | (x >> ((64 - n) & 63));
+}
+
+#define KECCAK_LANE lane_x4
+#define KECCAK_ROL rol64_x4
+#define KECCAK_FN(name) name##_x4
+#include "keccak_variants_body.h"
+CPU_TARGET_END
+#endif
+
+// VECTOR PERMUTATION
+
+// Per-width step dispatch and full permutation over W states held in
+// lane_xW registers. The selectors come pre-decoded from the
+// PreparedSchedule; each step is one switch per W states.
+#define DEFINE_BATCH_PERMUTE(W)                                              \
+    static void theta_x##W(lane_x##W A[25], int v) {                         \
+        switch (v) {                                                         \
+        case 0: theta_v0_x##W(A); break;                                     \
+        case 1: theta_v1_x##W(A); break;                                     \
+        case 2: theta_v2_x##W(A); break;                                     \
+        case 3: theta_v3_x##W(A); break;                                     \
+        case 4: theta_v4_x##W(A); break;                                     \
+        case 5: theta_v5_x##W(A); break;                                     \
+        default: theta_v6_x##W(A); break;                                    \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static void rhopi_x##W(lane_x##W A[25], int v) {                         \
+        switch (v) {                                                         \
+        case 0: rhopi_v0_x##W(A); break;                                     \
+        case 1: rhopi_v1_x##W(A); break;                                     \
+        case 2: rhopi_v2_x##W(A); break;                                     \
+        case 3: rhopi_v3_x##W(A); break;                                     \
+        case 4: rhopi_v4_x##W(A); break;                                     \
+        case 5: rhopi_v5_x##W(A); break;                                     \
+        default: rhopi_v6_x##W(A); break;                                    \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static void rhopi_to_x##W(lane_x##W B[25], const lane_x##W A[25], int v) { \
+        switch (v) {                                                         \
+        case 0: rhopi_v0_to_x##W(B, A); break;                               \
+        case 1: rhopi_v1_to_x##W(B, A); break;                               \
+        case 2: rhopi_v2_to_x##W(B, A); break;                               \
+        case 3: rhopi_v3_to_x##W(B, A); break;                               \
+        case 4: rhopi_v4_to_x##W(B, A); break;                               \
+        case 5: rhopi_v5_to_x##W(B, A); break;                               \
+        default: rhopi_v6_to_x##W(B, A); break;                              \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static void chi_x##W(lane_x##W A[25], const lane_x##W B[25], int v) {    \
+        switch (v) {                                                         \
+        case 0: chi_v0_x##W(A, B); break;                                    \
+        case 1: chi_v1_x##W(A, B); break;                                    \
+        case 2: chi_v2_x##W(A, B); break;                                    \
+        case 3: chi_v3_x##W(A, B); break;                                    \
+        case 4: chi_v4_x##W(A, B); break;                                    \
+        case 5: chi_v5_x##W(A, B); break;                                    \
+        default: chi_v6_x##W(A, B); break;                                   \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    static void permute_x##W(lane_x##W A[25], const PreparedSchedule *p) {   \
+        lane_x##W B[25];                                                     \
+                                                                             \
+        for (int r = 0; r < p->num_rounds; r++) {                            \
+            if (p->order[r] == 0) {                                          \
+                theta_x##W(A, p->theta[r]);                                  \
+                rhopi_to_x##W(B, A, p->rhopi[r]);                            \
+                chi_x##W(A, B, p->chi[r]);                                   \
+            } else {                                                         \
+                rhopi_x##W(A, p->rhopi[r]);                                  \
+                theta_x##W(A, p->theta[r]);                                  \
+                chi_x##W(A, A, p->chi[r]);                                   \
+            }                                                                \
+            A[0] ^= p->rc[r];                                                \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    /* Load W adjacent states starting at column j, permute, store back */   \
+    static void permute_group_x##W(u64 *lanes, size_t n, size_t j,           \
+                                   const PreparedSchedule *p) {              \
+        lane_x##W A[25];                                                     \
+                                                                             \
+        for (int i = 0; i < 25; i++) {                                       \
+            memcpy(&A[i], &lanes[i * n + j], sizeof(A[i]));                  \
+        }                                                                    \
+        permute_x##W(A, p);                                                  \
+        for (int i = 0; i < 25; i++) {                                       \
+            memcpy(&lanes[i * n + j], &A[i], sizeof(A[i]));                  \
+        }                                                                    \
+    }
+
+#ifdef KECCAK_BATCH_X8
+CPU_TARGET_BEGIN("avx512f")
+DEFINE_BATCH_PERMUTE(8)
+CPU_TARGET_END
+#endif
+
+#ifdef KECCAK_BATCH_X4
+CPU_TARGET_BEGIN("avx2")
+DEFINE_BATCH_PERMUTE(4)
+CPU_TARGET_END
+#endif
+
+// BATCH API
+
+// Permute state column j of an n-wide SoA block with the scalar kernels
+static void permute_scalar_column(u64 *lanes, size_t n, size_t j,
+                                  const PreparedSchedule *prepared) {
+    u64 A[25];
+
+    for (int i = 0; i < 25; i++) {
+        A[i] = lanes[i * n + j];
+    }
+    keccak_f_poly_prepared(A, prepared);
+    for (int i = 0; i < 25; i++) {
+        lanes[i * n + j] = A[i];
+    }
+}
+
+int keccak_batch_width(void) {
+    unsigned features = cpu_features();
+
+    (void)features;
+#ifdef KECCAK_BATCH_X8
+    if (features & CPU_AVX512) return 8;
+#endif
+#ifdef KECCAK_BATCH_X4
+    if (features & CPU_AVX2) return 4;
+#endif
+    return 1;
+}
+
+void keccak_f_poly_batch(u64 *lanes, size_t n, const PreparedSchedule *prepared) {
+    unsigned features = cpu_features();
+    size_t j = 0;
+    KECCAK_STATS_START(start);
+
+    (void)features;
+#ifdef KECCAK_BATCH_X8
+    if (features & CPU_AVX512) {
+        for (; j + 8 <= n; j += 8) {
+            permute_group_x8(lanes, n, j, prepared);
+        }
+    }
+#endif
+#ifdef KECCAK_BATCH_X4
+    if (features & CPU_AVX2) {
+        for (; j + 4 <= n; j += 4) {
+            permute_group_x4(lanes, n, j, prepared);
+        }
+    }
+#endif
+    // The scalar tail counts itself in keccak_f_poly_prepared
+    KECCAK_STATS_PERMUTATION(prepared, j, start);
+
+    // Scalar fallback for the tail
+    for (; j < n; j++) {
+        permute_scalar_column(lanes, n, j, prepared);
+    }
+}
+
+#if defined(KECCAK_BATCH_X8) || defined(KECCAK_BATCH_X4)
+
+// Two prepared schedules run the same permutation when they are the same
+// object or agree on every round
+static int same_prepared(const PreparedSchedule *a, const PreparedSchedule *b) {
+    size_t n = (size_t)a->num_rounds;
+
+    if (a == b) return 1;
+    return a->num_rounds == b->num_rounds &&
+           memcmp(a->order, b->order, n) == 0 && memcmp(a->theta, b->theta, n) == 0 &&
+           memcmp(a->rhopi, b->rhopi, n) == 0 && memcmp(a->chi, b->chi, n) == 0 &&
+           memcmp(a->rc, b->rc, n * sizeof(a->rc[0])) == 0;
+}
+
+// 1 if the w states from p[0] on share one schedule
+static int group_is_uniform(const PreparedSchedule *const *p, int w) {
+    for (int j = 1; j < w; j++) {
+        if (!same_prepared(p[0], p[j])) return 0;
+    }
+    return 1;
+}
+
+#endif
+
+void keccak_f_poly_divergent(u64 *lanes, size_t n, const PreparedSchedule *const *prepared) {
+    unsigned features = cpu_features();
+    size_t j = 0;
+
+    (void)features;
+#ifdef KECCAK_BATCH_X8
+    for (; (features & CPU_AVX512) && j + 8 <= n; j += 8) {
+        if (group_is_uniform(prepared + j, 8)) {
+            KECCAK_STATS_START(start);
+            permute_group_x8(lanes, n, j, prepared[j]);
+            KECCAK_STATS_PERMUTATION(prepared[j], 8, start);
+        } else {
+            for (size_t k = j; k < j + 8; k++) {
+                permute_scalar_column(lanes, n, k, prepared[k]);
+            }
+        }
+    }
+#endif
+#ifdef KECCAK_BATCH_X4
+    for (; (features & CPU_AVX2) && j + 4 <= n; j += 4) {
+        if (group_is_uniform(prepared + j, 4)) {
+            KECCAK_STATS_START(start);
+            permute_group_x4(lanes, n, j, prepared[j]);
+            KECCAK_STATS_PERMUTATION(prepared[j], 4, start);
+        } else {
+            for (size_t k = j; k < j + 4; k++) {
+                permute_scalar_column(lanes, n, k, prepared[k]);
+            }
+        }
+    }
+#endif
+
+    for (; j < n; j++) {
+        permute_scalar_column(lanes, n, j, prepared[j]);
+    }
+}
+
+// SCHEDULE GROUPING
+
+// States are transposed into structure-of-arrays chunks of this many states
+#define GROUP_CHUNK 64
+
+typedef struct {
+    const KeccakSchedule *schedule;
+    size_t index;
+} ScheduleRef;
+
+// Order schedules by round count, then by the rounds in use
+static int compare_schedules(const KeccakSchedule *a, const KeccakSchedule *b) {
+    if (a->num_rounds != b->num_rounds) {
+        return (a->num_rounds > b->num_rounds) - (a->num_rounds < b->num_rounds);
+    }
+    return memcmp(a->rounds, b->rounds, (size_t)a->num_rounds * sizeof(a->rounds[0]));
+}
+
+static int compare_schedule_refs(const void *a, const void *b) {
+    const ScheduleRef *x = (const ScheduleRef *)a;
+    const ScheduleRef *y = (const ScheduleRef *)b;
+    int c = compare_schedules(x->schedule, y->schedule);
+
+    if (c != 0) return c;
+    // Keep input order within a group
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static int same_schedule(const KeccakSchedule *a, const KeccakSchedule *b) {
+    return a == b || compare_schedules(a, b) == 0;
+}
+
+// Permute the states refs[0..count) under one prepared schedule
+static void run_group(u64 (*states)[25], const ScheduleRef *refs, size_t count,
+                      const PreparedSchedule *prepared) {
+    u64 lanes[25 * GROUP_CHUNK];
+
+    for (size_t base = 0; base < count; base += GROUP_CHUNK) {
+        size_t m = count - base < GROUP_CHUNK ? count - base : GROUP_CHUNK;
+
+        for (size_t j = 0; j < m; j++) {
+            const u64 *A = states[refs[base + j].index];
+            for (int i = 0; i < 25; i++) {
+                lanes[i * m + j] = A[i];
+            }
+        }
+
+        keccak_f_poly_batch(lanes, m, prepared);
+
+        for (size_t j = 0; j < m; j++) {
+            u64 *A = states[refs[base + j].index];
+            for (int i = 0; i < 25; i++) {
+                A[i] = lanes[i * m + j];
+            }
+        }
+    }
+}
+
+int keccak_f_poly_grouped(u64 (*states)[25], const KeccakSchedule *const *schedules, size_t n) {
+    if (n == 0) return 0;
+
+    // The round count sizes the comparison in the sort, so it is checked
+    // before sorting
+    for (size_t j = 0; j < n; j++) {
+        if (schedules[j]->num_rounds < 1 || schedules[j]->num_rounds > KECCAK_ROUNDS) {
+            return -1;
+        }
+    }
+
+    ScheduleRef *refs = (ScheduleRef*)malloc(n * sizeof(ScheduleRef));
+    if (!refs) return -1;
+
+    for (size_t j = 0; j < n; j++) {
+        refs[j].schedule = schedules[j];
+        refs[j].index = j;
+    }
+    qsort(refs, n, sizeof(ScheduleRef), compare_schedule_refs);
+
+    size_t groups = 0;
+    for (size_t g = 0; g < n; groups++) {
+        size_t end = g + 1;
+        while (end < n && same_schedule(refs[end].schedule, refs[g].schedule)) end++;
+        g = end;
+    }
+
+    // Prepare (and so validate) every group before touching any state
+    PreparedSchedule *prepared = (PreparedSchedule*)malloc(groups * sizeof(PreparedSchedule));
+    if (!prepared) {
+        free(refs);
+        return -1;
+    }
+    for (size_t g = 0, k = 0; g < n; k++) {
+        size_t end = g + 1;
+        while (end < n && same_schedule(refs[end].schedule, refs[g].schedule)) end++;
+
+        if (keccak_prepare_schedule(refs[g].schedule, &prepared[k]) != 0) {
+            free(prepared);
+            free(refs);
+            return -1;
+        }
+        g = end;
+    }
+
+    for (size_t g = 0, k = 0; g < n; k++) {
+        size_t end = g + 1;
+        while (end < n && same_schedule(refs[end].schedule, refs[g].schedule)) end++;
+
+        run_group(states, refs + g, end - g, &prepared[k]);
+        g = end;
+    }
+
+    free(prepared);
+    free(refs);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef KECCAK_BATCH_H
+#define KECCAK_BATCH_H
+
+#include <stddef.h>
+#include "keccak_engine.h"
+
+// Widest SIMD group in use (see cpu_dispatch.h): 8 with AVX-512F, 4 with
+// AVX2, 1 when only the scalar kernels are available or enabled
+int keccak_batch_width(void);
+
+// Permute n states stored structure-of-arrays, all under one prepared
+// schedule: lane i of state j is lanes[i * n + j]. Full groups run in
+// lockstep through the widest vector kernels; the tail runs scalar.
+void keccak_f_poly_batch(u64 *lanes, size_t n, const PreparedSchedule *prepared);
+
+// Permute n states stored structure-of-arrays (same layout as
+// keccak_f_poly_batch), state j under its own prepared[j]. Each aligned
+// group of vector width whose states share one schedule runs in lockstep;
+// any other group runs state by state on the scalar kernels. Per-message
+// plaintext schedules practically never agree, so such batches run scalar:
+// sharing the registers between different variants (evaluating each and
+// blending per lane, or regrouping states by variant every step) costs
+// more than the scalar kernels. To gather states with equal schedules from
+// anywhere in a batch, use keccak_f_poly_grouped.
+void keccak_f_poly_divergent(u64 *lanes, size_t n, const PreparedSchedule *const *prepared);
+
+// Permute n array-of-structures states, state j under schedules[j].
+// States whose schedules are identical are grouped, the schedule is prepared
+// once per group and each group is run through keccak_f_poly_batch.
+// Returns 0 on success, -1 on allocation failure or an invalid schedule
+// (states are left untouched in that case).
+int keccak_f_poly_grouped(u64 (*states)[25], const KeccakSchedule *const *schedules, size_t n);
+
+#endif // KECCAK_BATCH_H
@@ -0,0 +1,238 @@
+#include "keccak_engine.h"
+#include "keccak_stats.h"
+#include "keccak_variants_impl.h"
+
+// VARIANT DISPATCH TABLES
+
+const keccak_step_fn THETA_VARIANTS[KECCAK_VARIANTS] = {
+    theta_v0, theta_v1, theta_v2, theta_v3, theta_v4, theta_v5, theta_v6
+};
+
+const keccak_step_fn RHOPI_VARIANTS[KECCAK_VARIANTS] = {
+    rhopi_v0, rhopi_v1, rhopi_v2, rhopi_v3, rhopi_v4, rhopi_v5, rhopi_v6
+};
+
+const keccak_step_fn CHI_VARIANTS[KECCAK_VARIANTS] = {
+    chi_v0, chi_v1, chi_v2, chi_v3, chi_v4, chi_v5, chi_v6
+};
+
+const keccak_iota_fn IOTA_VARIANTS[KECCAK_VARIANTS] = {
+    iota_v0, iota_v1, iota_v2, iota_v3, iota_v4, iota_v5, iota_v6
+};
+
+static const keccak_step_fn *const STEP_TABLES[3] = {
+    THETA_VARIANTS, RHOPI_VARIANTS, CHI_VARIANTS
+};
+
+// FUSED RHO-PI + CHI
+
+// Rho-pi scatters into B and chi reads B back into A, so the pair needs no
+// copy-back. Usable whenever rho-pi directly precedes chi (θ-first rounds).
+#define DEFINE_RHOPI_CHI(R, C)                                               \
+    static void rhopi_chi_v##R##_v##C(u64 A[25]) {                           \
+        u64 B[25];                                                           \
+        rhopi_v##R##_to_impl(B, A);                                          \
+        chi_v##C##_impl(A, B);                                               \
+    }
+
+#define RHOPI_CHI_ENTRY(R, C) [R][C] = rhopi_chi_v##R##_v##C,
+
+#define EACH_CHI_OF(M, R) \
+    M(R, 0) M(R, 1) M(R, 2) M(R, 3) M(R, 4) M(R, 5) M(R, 6)
+#define EACH_RHOPI_CHI(M) \
+    EACH_CHI_OF(M, 0) EACH_CHI_OF(M, 1) EACH_CHI_OF(M, 2) EACH_CHI_OF(M, 3) \
+    EACH_CHI_OF(M, 4) EACH_CHI_OF(M, 5) EACH_CHI_OF(M, 6)
+
+EACH_RHOPI_CHI(DEFINE_RHOPI_CHI)
+
+const keccak_step_fn RHOPI_CHI_VARIANTS[KECCAK_VARIANTS][KECCAK_VARIANTS] = {
+    EACH_RHOPI_CHI(RHOPI_CHI_ENTRY)
+};
+
+// FUSED ROUND KERNELS
+
+// Each kernel inlines its step bodies with every lane index constant, so the
+// compiler keeps the lanes in registers for the whole round and only the
+// final value of each lane is stored back to A. θ-first rounds take the
+// fused ρπ -> χ ping-pong path through B; ρπ-first rounds permute in place
+// and run χ in place after θ.
+#define DEFINE_ROUND_KERNEL(O, T, R, C)                                      \
+    static void round_o##O##_t##T##_r##R##_c##C(u64 A[25], u64 rc) {        \
+        u64 B[25];                                                           \
+        if (O == 0) {                                                        \
+            theta_v##T##_impl(A);                                            \
+            rhopi_v##R##_to_impl(B, A);                                      \
+            chi_v##C##_impl(A, B);                                           \
+        } else {                                                             \
+            rhopi_v##R##_impl(A);                                            \
+            theta_v##T##_impl(A);                                            \
+            chi_v##C##_impl(A, A);                                           \
+        }                                                                    \
+        A[0] ^= rc;                                                          \
+    }
+
+#define ROUND_KERNEL_ENTRY(O, T, R, C) \
+    [O][T][R][C] = round_o##O##_t##T##_r##R##_c##C,
+
+// Expand M(order, theta, rhopi, chi) over all 2 x 7 x 7 x 7 combinations
+#define EACH_CHI(M, O, T, R) \
+    M(O, T, R, 0) M(O, T, R, 1) M(O, T, R, 2) M(O, T, R, 3) \
+    M(O, T, R, 4) M(O, T, R, 5) M(O, T, R, 6)
+#define EACH_RHOPI(M, O, T) \
+    EACH_CHI(M, O, T, 0) EACH_CHI(M, O, T, 1) EACH_CHI(M, O, T, 2) \
+    EACH_CHI(M, O, T, 3) EACH_CHI(M, O, T, 4) EACH_CHI(M, O, T, 5) \
+    EACH_CHI(M, O, T, 6)
+#define EACH_THETA(M, O) \
+    EACH_RHOPI(M, O, 0) EACH_RHOPI(M, O, 1) EACH_RHOPI(M, O, 2) \
+    EACH_RHOPI(M, O, 3) EACH_RHOPI(M, O, 4) EACH_RHOPI(M, O, 5) \
+    EACH_RHOPI(M, O, 6)
+#define EACH_ROUND_KERNEL(M) EACH_THETA(M, 0) EACH_THETA(M, 1)
+
+EACH_ROUND_KERNEL(DEFINE_ROUND_KERNEL)
+
+const keccak_round_fn ROUND_KERNELS[2][KECCAK_VARIANTS][KECCAK_VARIANTS][KECCAK_VARIANTS] = {
+    EACH_ROUND_KERNEL(ROUND_KERNEL_ENTRY)
+};
+
+// SCHEDULE PREPARATION
+
+// A round is valid when θ/ρπ occupy the first two slots in either order,
+// followed by χ and ι, and every variant is in range.
+static int round_is_valid(const RoundSchedule *rs) {
+    int first = rs->step_order[0];
+    int second = rs->step_order[1];
+
+    if (!((first == STEP_THETA && second == STEP_RHOPI) ||
+          (first == STEP_RHOPI && second == STEP_THETA))) {
+        return 0;
+    }
+    if (rs->step_order[2] != STEP_CHI || rs->step_order[3] != STEP_IOTA) {
+        return 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (rs->variants[i] < 0 || rs->variants[i] >= KECCAK_VARIANTS) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int keccak_prepare_schedule(const KeccakSchedule *schedule, PreparedSchedule *prepared) {
+    int n = schedule->num_rounds;
+
+    if (n < 1 || n > KECCAK_ROUNDS) {
+        return -1;
+    }
+    prepared->num_rounds = n;
+
+    for (int r = 0; r < n; r++) {
+        const RoundSchedule *rs = &schedule->rounds[r];
+
+        if (!round_is_valid(rs)) {
+            return -1;
+        }
+
+        // variants[i] belongs to the step at position i, not to step i
+        int order = (rs->step_order[0] == STEP_THETA) ? 0 : 1;
+        int theta = rs->variants[order == 0 ? 0 : 1];
+        int rhopi = rs->variants[order == 0 ? 1 : 0];
+        int chi = rs->variants[2];
+        prepared->rounds[r] = ROUND_KERNELS[order][theta][rhopi][chi];
+        prepared->order[r] = (uint8_t)order;
+        prepared->theta[r] = (uint8_t)theta;
+        prepared->rhopi[r] = (uint8_t)rhopi;
+        prepared->chi[r] = (uint8_t)chi;
+        KECCAK_STATS_ONLY(prepared->iota[r] = (uint8_t)rs->variants[3];)
+
+        // Reduced-round permutations keep the last n constants
+        prepared->rc[r] = IOTA_RC[rs->variants[3]][KECCAK_ROUNDS - n + r];
+    }
+
+    return 0;
+}
+
+int keccak_prepare_packed(const PackedSchedule *packed, PreparedSchedule *prepared) {
+    int n = schedule_packed_rounds(packed);
+
+    if (n < 1 || n > KECCAK_ROUNDS) {
+        return -1;
+    }
+    prepared->num_rounds = n;
+
+    for (int r = 0; r < n; r++) {
+        unsigned bits = schedule_packed_round(packed, r);
+        unsigned order = SCHEDULE_PACK_ORDER(bits);
+        unsigned theta = SCHEDULE_PACK_THETA(bits);
+        unsigned rhopi = SCHEDULE_PACK_RHOPI(bits);
+        unsigned chi = SCHEDULE_PACK_CHI(bits);
+        unsigned iota = SCHEDULE_PACK_IOTA(bits);
+
+        if (theta >= KECCAK_VARIANTS || rhopi >= KECCAK_VARIANTS ||
+            chi >= KECCAK_VARIANTS || iota >= KECCAK_VARIANTS) {
+            return -1;
+        }
+        prepared->rounds[r] = ROUND_KERNELS[order][theta][rhopi][chi];
+        prepared->order[r] = (uint8_t)order;
+        prepared->theta[r] = (uint8_t)theta;
+        prepared->rhopi[r] = (uint8_t)rhopi;
+        prepared->chi[r] = (uint8_t)chi;
+        KECCAK_STATS_ONLY(prepared->iota[r] = (uint8_t)iota;)
+        prepared->rc[r] = IOTA_RC[iota][KECCAK_ROUNDS - n + r];
+    }
+
+    return 0;
+}
+
+// PERMUTATION
+
+void keccak_f_poly_prepared(u64 A[25], const PreparedSchedule *prepared) {
+    KECCAK_STATS_START(start);
+
+    for (int r = 0; r < prepared->num_rounds; r++) {
+        prepared->rounds[r](A, prepared->rc[r]);
+    }
+    KECCAK_STATS_PERMUTATION(prepared, 1, start);
+}
+
+// With KECCAK_STATS every kernel is timed as it runs: θ, ι and a ρπ or χ on
+// its own as a step, the fused ρπ + χ pair as one sample
+int keccak_f_poly(u64 A[25], const KeccakSchedule *schedule) {
+    int first = KECCAK_ROUNDS - schedule->num_rounds;
+
+    // Same checks as keccak_prepare_schedule, before A is touched
+    if (schedule->num_rounds < 1 || schedule->num_rounds > KECCAK_ROUNDS) {
+        return -1;
+    }
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        if (!round_is_valid(&schedule->rounds[r])) {
+            return -1;
+        }
+    }
+
+    KECCAK_STATS_START(permutation_start);
+
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        const RoundSchedule *rs = &schedule->rounds[r];
+
+        KECCAK_STATS_ROUND(rs->step_order[0] == STEP_RHOPI);
+        for (int i = 0; i < 4; i++) {
+            int step = rs->step_order[i];
+            int variant = rs->variants[i];
+            KECCAK_STATS_START(start);
+
+            if (step == STEP_IOTA) {
+                IOTA_VARIANTS[variant](A, first + r);
+                KECCAK_STATS_STEP(step, variant, start);
+            } else if (step == STEP_RHOPI && i < 3 && rs->step_order[i + 1] == STEP_CHI) {
+                RHOPI_CHI_VARIANTS[variant][rs->variants[i + 1]](A);
+                KECCAK_STATS_FUSED(variant, rs->variants[i + 1], start);
+                i++;
+            } else {
+                STEP_TABLES[step][variant](A);
+                KECCAK_STATS_STEP(step, variant, start);
+            }
+        }
+    }
+    KECCAK_STATS_PERMUTATION(NULL, 1, permutation_start);
+    return 0;
+}
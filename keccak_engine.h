@@ -0,0 +1,75 @@
+#ifndef KECCAK_ENGINE_H
+#define KECCAK_ENGINE_H
+
+#include "keccak_variants.h"
+#include "seed_generation.h"
+#include "schedule_pack.h"
+
+// Step identifiers as stored in RoundSchedule.step_order
+#define STEP_THETA 0
+#define STEP_RHOPI 1
+#define STEP_CHI   2
+#define STEP_IOTA  3
+
+#define KECCAK_ROUNDS   KECCAK_ROUNDS_FULL   // maximum round count
+#define KECCAK_VARIANTS 7
+
+// Step function signatures
+typedef void (*keccak_step_fn)(u64 A[25]);
+typedef void (*keccak_iota_fn)(u64 A[25], int round);
+
+// Fused round kernel: θ/ρπ (in scheduled order), χ, then ι with the
+// round constant already resolved for the scheduled iota variant
+typedef void (*keccak_round_fn)(u64 A[25], u64 rc);
+
+// Per-step variant tables, indexed by variant number (0-6)
+extern const keccak_step_fn THETA_VARIANTS[KECCAK_VARIANTS];
+extern const keccak_step_fn RHOPI_VARIANTS[KECCAK_VARIANTS];
+extern const keccak_step_fn CHI_VARIANTS[KECCAK_VARIANTS];
+extern const keccak_iota_fn IOTA_VARIANTS[KECCAK_VARIANTS];
+
+// Fused rho-pi + chi, indexed [rhopi variant][chi variant]
+extern const keccak_step_fn RHOPI_CHI_VARIANTS[KECCAK_VARIANTS][KECCAK_VARIANTS];
+
+// Fused kernels for every (order, theta, rhopi, chi) combination.
+// Order 0 runs θ before ρπ, order 1 runs ρπ before θ. Iota is not a
+// kernel dimension: all iota variants XOR a per-round constant into A[0].
+extern const keccak_round_fn ROUND_KERNELS[2][KECCAK_VARIANTS][KECCAK_VARIANTS][KECCAK_VARIANTS];
+
+// Schedule resolved into one fused kernel and one round constant per round.
+// The decoded selectors are kept for kernels chosen at run time per round
+// (the SIMD batch engine), so they never re-read the RoundSchedule either.
+// Entries [0, num_rounds) are used; rc already holds the constant of the
+// round's position in the full permutation.
+typedef struct {
+    int num_rounds;
+    keccak_round_fn rounds[KECCAK_ROUNDS];
+    u64 rc[KECCAK_ROUNDS];
+    uint8_t order[KECCAK_ROUNDS];   // 0 = θ first, 1 = ρπ first
+    uint8_t theta[KECCAK_ROUNDS];
+    uint8_t rhopi[KECCAK_ROUNDS];
+    uint8_t chi[KECCAK_ROUNDS];
+#ifdef KECCAK_STATS
+    uint8_t iota[KECCAK_ROUNDS];    // only read by the statistics (keccak_stats.h)
+#endif
+} PreparedSchedule;
+
+// Resolve a schedule into a PreparedSchedule.
+// Returns 0 on success, -1 if the schedule holds an invalid step, variant or
+// round count.
+int keccak_prepare_schedule(const KeccakSchedule *schedule, PreparedSchedule *prepared);
+
+// Resolve a packed schedule straight into a PreparedSchedule, one table
+// lookup per round, with no KeccakSchedule in between. Returns 0, or -1 if
+// the round count or a variant is out of range.
+int keccak_prepare_packed(const PackedSchedule *packed, PreparedSchedule *prepared);
+
+// Run the permutation (num_rounds rounds) on a prepared schedule
+void keccak_f_poly_prepared(u64 A[25], const PreparedSchedule *prepared);
+
+// Run the permutation directly from a schedule (decodes every step).
+// Returns 0, or -1 with A untouched if the schedule is one
+// keccak_prepare_schedule would reject.
+int keccak_f_poly(u64 A[25], const KeccakSchedule *schedule);
+
+#endif // KECCAK_ENGINE_H
@@ -0,0 +1,257 @@
+#include <string.h>
+
+#include "keccak_mac.h"
+#include "keccak_batch.h"
+
+// Messages run in lockstep per SIMD batch call (a multiple of every vector
+// width)
+#define MAC_GROUP 16
+
+#if KECCAK_MAC_TAG % 8 != 0 || KECCAK_MAC_TAG > KECCAK_SPONGE_RATE
+#error "KECCAK_MAC_TAG must be whole lanes of one rate block"
+#endif
+
+// Function name of the prefix block, as in KMAC
+static const char MAC_NAME[] = "KMAC";
+
+// SP 800-185 ENCODINGS
+
+// Big-endian bytes of x without leading zeros (at least one byte)
+static size_t encode_bytes(uint64_t x, uint8_t *out) {
+    size_t n = 1;
+
+    while (n < 8 && (x >> (8 * n)) != 0) {
+        n++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint8_t)(x >> (8 * (n - 1 - i)));
+    }
+    return n;
+}
+
+// left_encode(x): byte count, then the bytes
+static size_t left_encode(uint64_t x, uint8_t out[9]) {
+    size_t n = encode_bytes(x, out + 1);
+    out[0] = (uint8_t)n;
+    return n + 1;
+}
+
+// right_encode(x): the bytes, then the byte count
+static size_t right_encode(uint64_t x, uint8_t out[9]) {
+    size_t n = encode_bytes(x, out);
+    out[n] = (uint8_t)n;
+    return n + 1;
+}
+
+// Absorb encode_string(s) = left_encode(8 * |s|) || s; returns bytes absorbed
+static size_t absorb_string(KeccakSponge *ctx, const char *s) {
+    uint8_t enc[9];
+    size_t len = strlen(s);
+    size_t e = left_encode(8 * (uint64_t)len, enc);
+
+    keccak_sponge_update(ctx, enc, e);
+    keccak_sponge_update(ctx, (const uint8_t*)s, len);
+    return e + len;
+}
+
+// bytepad(..., rate): left_encode(rate) was absorbed as part of `used`;
+// zero-fill to the block boundary
+static void absorb_block_end(KeccakSponge *ctx, size_t used) {
+    static const uint8_t zeros[KECCAK_SPONGE_RATE];
+
+    keccak_sponge_update(ctx, zeros, (KECCAK_SPONGE_RATE - used % KECCAK_SPONGE_RATE) %
+                                     KECCAK_SPONGE_RATE);
+}
+
+static size_t absorb_rate(KeccakSponge *ctx) {
+    uint8_t enc[9];
+    size_t e = left_encode(KECCAK_SPONGE_RATE, enc);
+
+    keccak_sponge_update(ctx, enc, e);
+    return e;
+}
+
+// Final block(s) of a message: its last r (< RATE) bytes, then
+// right_encode(8 * tag_len) and pad10*1. Returns the block count, 1 or 2.
+static size_t mac_tail(const uint8_t *tail, size_t r, size_t tag_len,
+                       uint8_t blocks[2 * KECCAK_SPONGE_RATE]) {
+    uint8_t enc[9];
+    size_t e = right_encode(8 * (uint64_t)tag_len, enc);
+    size_t used = r + e;
+    size_t count = used / KECCAK_SPONGE_RATE + 1;
+
+    memset(blocks, 0, count * KECCAK_SPONGE_RATE);
+    memcpy(blocks, tail, r);
+    memcpy(blocks + r, enc, e);
+    blocks[used] ^= KECCAK_MAC_PAD;
+    blocks[count * KECCAK_SPONGE_RATE - 1] ^= 0x80;
+    return count;
+}
+
+static inline void absorb_lanes(u64 A[25], const uint8_t *block) {
+    for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+        A[i] ^= load64_le(block + 8 * i);
+    }
+}
+
+// KEY SNAPSHOT
+
+void keccak_mac_init_prepared(KeccakMac *mac, const PreparedSchedule *prepared,
+                              const char *key, const char *custom) {
+    KeccakSponge ctx;
+    size_t used;
+
+    keccak_sponge_init_prepared(&ctx, prepared);
+
+    // bytepad(encode_string(N) || encode_string(S), rate)
+    used = absorb_rate(&ctx);
+    used += absorb_string(&ctx, MAC_NAME);
+    used += absorb_string(&ctx, custom ? custom : "");
+    absorb_block_end(&ctx, used);
+
+    // bytepad(encode_string(K), rate)
+    used = absorb_rate(&ctx);
+    used += absorb_string(&ctx, key);
+    absorb_block_end(&ctx, used);
+
+    // Both ended on a block boundary, so the state is all there is
+    memcpy(mac->state, ctx.state, sizeof(mac->state));
+    mac->prepared = *prepared;
+}
+
+int keccak_mac_init(KeccakMac *mac, const char *key, const char *custom) {
+    KeccakSchedule schedule;
+    PreparedSchedule prepared;
+
+    generate_schedule_from_key(key, &schedule);
+    if (keccak_prepare_schedule(&schedule, &prepared) != 0) {
+        return -1;
+    }
+    keccak_mac_init_prepared(mac, &prepared, key, custom);
+    return 0;
+}
+
+// SINGLE MESSAGES
+
+void keccak_mac_start(const KeccakMac *mac, KeccakSponge *ctx) {
+    memcpy(ctx->state, mac->state, sizeof(ctx->state));
+    ctx->prepared = mac->prepared;
+    ctx->pos = 0;
+    ctx->squeezing = 0;
+}
+
+void keccak_mac_finish(KeccakSponge *ctx, uint8_t *tag, size_t tag_len) {
+    uint8_t enc[9];
+
+    keccak_sponge_update(ctx, enc, right_encode(8 * (uint64_t)tag_len, enc));
+    keccak_sponge_final_pad(ctx, KECCAK_MAC_PAD);
+    keccak_sponge_squeeze(ctx, tag, tag_len);
+}
+
+// Works on a copy of the 200-byte state only, reading the schedule in place
+void keccak_mac(const KeccakMac *mac, const uint8_t *msg, size_t len, uint8_t *tag,
+                size_t tag_len) {
+    uint8_t tail[2 * KECCAK_SPONGE_RATE];
+    size_t full = len / KECCAK_SPONGE_RATE;
+    size_t count;
+    u64 A[25];
+
+    memcpy(A, mac->state, sizeof(A));
+    for (size_t b = 0; b < full; b++) {
+        absorb_lanes(A, msg + b * KECCAK_SPONGE_RATE);
+        keccak_f_poly_prepared(A, &mac->prepared);
+    }
+    count = mac_tail(msg + full * KECCAK_SPONGE_RATE, len % KECCAK_SPONGE_RATE, tag_len, tail);
+    for (size_t b = 0; b < count; b++) {
+        absorb_lanes(A, tail + b * KECCAK_SPONGE_RATE);
+        keccak_f_poly_prepared(A, &mac->prepared);
+    }
+
+    for (size_t i = 0; i < tag_len; i++) {
+        size_t pos = i % KECCAK_SPONGE_RATE;
+        if (i > 0 && pos == 0) {
+            keccak_f_poly_prepared(A, &mac->prepared);
+        }
+        tag[i] = (uint8_t)(A[pos / 8] >> (8 * (pos % 8)));
+    }
+}
+
+int keccak_mac_verify(const KeccakMac *mac, const uint8_t *msg, size_t len,
+                      const uint8_t *tag, size_t tag_len) {
+    KeccakSponge ctx;
+    uint8_t expected[KECCAK_SPONGE_RATE];
+    uint8_t enc[9];
+    uint8_t diff = 0;
+
+    keccak_mac_start(mac, &ctx);
+    keccak_sponge_update(&ctx, msg, len);
+    keccak_sponge_update(&ctx, enc, right_encode(8 * (uint64_t)tag_len, enc));
+    keccak_sponge_final_pad(&ctx, KECCAK_MAC_PAD);
+
+    // Any tag length, one rate block of expected tag at a time
+    for (size_t off = 0; off < tag_len; off += sizeof(expected)) {
+        size_t n = tag_len - off < sizeof(expected) ? tag_len - off : sizeof(expected);
+
+        keccak_sponge_squeeze(&ctx, expected, n);
+        for (size_t i = 0; i < n; i++) {
+            diff |= (uint8_t)(expected[i] ^ tag[off + i]);
+        }
+    }
+    return diff == 0 ? 0 : -1;
+}
+
+// BATCH
+
+// count <= MAC_GROUP messages as one structure-of-arrays batch. Every state
+// is permuted as often as the longest message needs; a tag is read out right
+// after the permutation that completes its message.
+static void mac_group(const KeccakMac *mac, const uint8_t *const *msgs, const size_t *lens,
+                      size_t count, uint8_t (*tags)[KECCAK_MAC_TAG]) {
+    u64 lanes[25 * MAC_GROUP];
+    uint8_t tails[MAC_GROUP][2 * KECCAK_SPONGE_RATE];
+    size_t full[MAC_GROUP], blocks[MAC_GROUP];
+    size_t most = 0;
+
+    for (size_t j = 0; j < count; j++) {
+        full[j] = lens[j] / KECCAK_SPONGE_RATE;
+        blocks[j] = full[j] + mac_tail(msgs[j] + full[j] * KECCAK_SPONGE_RATE,
+                                       lens[j] % KECCAK_SPONGE_RATE, KECCAK_MAC_TAG, tails[j]);
+        most = blocks[j] > most ? blocks[j] : most;
+    }
+    for (int i = 0; i < 25; i++) {
+        for (size_t j = 0; j < count; j++) {
+            lanes[i * count + j] = mac->state[i];
+        }
+    }
+
+    for (size_t b = 0; b < most; b++) {
+        for (size_t j = 0; j < count; j++) {
+            if (b >= blocks[j]) {
+                continue;
+            }
+            const uint8_t *block = b < full[j] ? msgs[j] + b * KECCAK_SPONGE_RATE
+                                               : tails[j] + (b - full[j]) * KECCAK_SPONGE_RATE;
+            for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+                lanes[i * count + j] ^= load64_le(block + 8 * i);
+            }
+        }
+        keccak_f_poly_batch(lanes, count, &mac->prepared);
+
+        for (size_t j = 0; j < count; j++) {
+            if (blocks[j] != b + 1) {
+                continue;
+            }
+            for (int i = 0; i < KECCAK_MAC_TAG / 8; i++) {
+                store64_le(tags[j] + 8 * i, lanes[i * count + j]);
+            }
+        }
+    }
+}
+
+void keccak_mac_batch(const KeccakMac *mac, const uint8_t *const *msgs, const size_t *lens,
+                      size_t n, uint8_t (*tags)[KECCAK_MAC_TAG]) {
+    for (size_t j = 0; j < n; j += MAC_GROUP) {
+        size_t count = n - j < MAC_GROUP ? n - j : MAC_GROUP;
+        mac_group(mac, msgs + j, lens + j, count, tags + j);
+    }
+}
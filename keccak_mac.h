@@ -0,0 +1,69 @@
+#ifndef KECCAK_MAC_H
+#define KECCAK_MAC_H
+
+#include <stddef.h>
+#include "keccak_sponge.h"
+
+// Keyed MAC in the style of KMAC256, over the polymorphic permutation under
+// the keyed-mode schedule of the key (generate_schedule_from_key):
+//     prefix = bytepad(encode_string("KMAC") || encode_string(S), 136)
+//     tag    = sponge(prefix || bytepad(encode_string(K), 136)
+//                     || X || right_encode(8 * tag_len))    with domain bits 00
+// The encodings are those of NIST SP 800-185, so under the all-V0 schedule
+// this is KMAC256 itself.
+//
+// prefix and the key block fill whole blocks, so the state after them does
+// not depend on the message. keccak_mac_init derives the schedule and
+// absorbs both once; every message then starts from a copy of that
+// snapshot, and a message of up to KECCAK_MAC_SHORT bytes costs a single
+// permutation.
+
+// Domain bits '00' followed by the first '1' of pad10*1 (cSHAKE's)
+#define KECCAK_MAC_PAD 0x04
+
+// Tag size of the batch API (and a sensible default for single messages)
+#define KECCAK_MAC_TAG 32
+
+// Longest message that fits one block with right_encode(8 * KECCAK_MAC_TAG)
+// and the padding
+#define KECCAK_MAC_SHORT (KECCAK_SPONGE_RATE - 4)
+
+// State once the key has been absorbed, plus its schedule. Read-only once
+// set up, so any number of threads may MAC with it.
+typedef struct {
+    u64 state[25];
+    PreparedSchedule prepared;
+} KeccakMac;
+
+// Derive the schedule of key and absorb the customization string and the
+// key. custom may be NULL (empty). Returns 0, or -1 if the derived schedule
+// is invalid.
+int keccak_mac_init(KeccakMac *mac, const char *key, const char *custom);
+
+// Same under an already prepared keyed-mode schedule of key
+void keccak_mac_init_prepared(KeccakMac *mac, const PreparedSchedule *prepared,
+                              const char *key, const char *custom);
+
+// Streaming MAC of one message, started from the snapshot
+void keccak_mac_start(const KeccakMac *mac, KeccakSponge *ctx);
+
+// Finish a streaming MAC with a tag of tag_len bytes
+void keccak_mac_finish(KeccakSponge *ctx, uint8_t *tag, size_t tag_len);
+
+// One-shot MAC of a message
+void keccak_mac(const KeccakMac *mac, const uint8_t *msg, size_t len, uint8_t *tag,
+                size_t tag_len);
+
+// Compare a received tag with the MAC of msg in constant time.
+// Returns 0 if it matches, -1 otherwise.
+int keccak_mac_verify(const KeccakMac *mac, const uint8_t *msg, size_t len,
+                      const uint8_t *tag, size_t tag_len);
+
+// KECCAK_MAC_TAG-byte tags of n messages under one snapshot; tags[j]
+// belongs to msgs[j]. Messages are run 16 at a time in lockstep on the SIMD
+// batch kernels, one permutation per block of the longest message in each
+// group, so short messages of similar lengths batch best.
+void keccak_mac_batch(const KeccakMac *mac, const uint8_t *const *msgs, const size_t *lens,
+                      size_t n, uint8_t (*tags)[KECCAK_MAC_TAG]);
+
+#endif // KECCAK_MAC_H
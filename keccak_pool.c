@@ -0,0 +1,372 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // pthread_setaffinity_np, sched_getaffinity
+#elif !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L // posix_memalign under -std=c99
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "keccak_pool.h"
+#include "seed_batch.h"
+
+// Messages taken from a range at a time. Matches the multi-buffer SHA-256
+// width so plaintext-mode seeds for a chunk are derived in one call.
+#define POOL_CHUNK 16
+
+// Ranges pack [begin, end) into one word so owner and thieves can update
+// them with a single CAS; batches larger than this are submitted in slices
+#define POOL_MAX_BATCH 0xffffffffu
+
+// WORKER STATE
+
+// Per-worker arena, cache-line aligned so workers never share a line
+typedef struct {
+    uint64_t range __attribute__((aligned(64)));   // begin | end << 32
+    KeccakPool *pool;
+    pthread_t thread;
+    int index;
+    KeccakSponge sponge;
+    KeccakSchedule schedule;
+    uint8_t seeds[POOL_CHUNK][32];
+} __attribute__((aligned(64))) PoolWorker;
+
+struct KeccakPool {
+    PoolWorker *workers;
+    int threads;
+    int started;                // worker threads successfully created
+
+    // Job published to the workers (written before generation is bumped)
+    keccak_pool_fn fn;          // keccak_pool_run job when not NULL (msgs unused)
+    void *ctx;
+    size_t base;                // index passed to fn for job index 0
+    const uint8_t *const *msgs;
+    const size_t *lens;
+    const PreparedSchedule *prepared;
+    uint8_t (*digests)[KECCAK_POOL_DIGEST];
+
+    // Sleeping and waking only; the work itself is distributed lock-free
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    uint64_t generation;
+    int pending;                // workers still running the current job
+    int shutdown;
+};
+
+// RANGES
+
+static inline uint64_t range_pack(uint32_t begin, uint32_t end) {
+    return (uint64_t)begin | ((uint64_t)end << 32);
+}
+
+// Owner: take up to POOL_CHUNK indices from the front of its range
+static int range_take(PoolWorker *w, uint32_t *begin, uint32_t *end) {
+    uint64_t r = __atomic_load_n(&w->range, __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        uint32_t b = (uint32_t)r;
+        uint32_t e = (uint32_t)(r >> 32);
+        if (b >= e) {
+            return 0;
+        }
+        uint32_t nb = e - b > POOL_CHUNK ? b + POOL_CHUNK : e;
+        if (__atomic_compare_exchange_n(&w->range, &r, range_pack(nb, e), 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *begin = b;
+            *end = nb;
+            return 1;
+        }
+    }
+}
+
+// Thief: move the back half of some other worker's range into its own
+// (empty) range. Returns 0 once every other range is down to one chunk.
+static int range_steal(PoolWorker *w) {
+    KeccakPool *pool = w->pool;
+
+    for (int k = 1; k < pool->threads; k++) {
+        PoolWorker *victim = &pool->workers[(w->index + k) % pool->threads];
+        uint64_t r = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+
+        for (;;) {
+            uint32_t b = (uint32_t)r;
+            uint32_t e = (uint32_t)(r >> 32);
+            if (e <= b || e - b <= POOL_CHUNK) {
+                break;
+            }
+            uint32_t mid = b + (e - b) / 2;
+            if (__atomic_compare_exchange_n(&victim->range, &r, range_pack(b, mid), 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                // Our range is empty, so no thief is racing on it
+                __atomic_store_n(&w->range, range_pack(mid, e), __ATOMIC_RELEASE);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// HASHING
+
+static void hash_chunk(PoolWorker *w, uint32_t begin, uint32_t end) {
+    KeccakPool *pool = w->pool;
+    size_t count = end - begin;
+
+    if (pool->fn != NULL) {
+        pool->fn(pool->ctx, pool->base + begin, pool->base + end);
+        return;
+    }
+
+    if (pool->prepared == NULL) {
+        // seed = SHA256(domain_separator || msg), POOL_CHUNK streams at once
+        sha256_batch(&SHA256_MIDSTATE_MSG, pool->msgs + begin, pool->lens + begin, count, w->seeds);
+    }
+
+    for (size_t j = 0; j < count; j++) {
+        size_t i = begin + j;
+
+        if (pool->prepared == NULL) {
+            generate_schedule_internal(w->seeds[j], &w->schedule);
+            keccak_sponge_init(&w->sponge, &w->schedule);
+        } else {
+            keccak_sponge_init_prepared(&w->sponge, pool->prepared);
+        }
+        keccak_sponge_update(&w->sponge, pool->msgs[i], pool->lens[i]);
+        keccak_sponge_squeeze(&w->sponge, pool->digests[i], KECCAK_POOL_DIGEST);
+    }
+}
+
+// Drain the own range, then steal until no range has work left to split
+static void worker_run(PoolWorker *w) {
+    uint32_t begin, end;
+
+    for (;;) {
+        while (range_take(w, &begin, &end)) {
+            hash_chunk(w, begin, end);
+        }
+        if (!range_steal(w)) {
+            return;
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    PoolWorker *w = (PoolWorker*)arg;
+    KeccakPool *pool = w->pool;
+    uint64_t seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        worker_run(w);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// POOL LIFETIME
+
+#ifdef __linux__
+#define POOL_MAX_CPUS CPU_SETSIZE
+#else
+#define POOL_MAX_CPUS 1
+#endif
+
+// CPUs the calling thread may run on (its affinity mask, which reflects
+// cpusets and taskset), in increasing order. Returns their count, 0 if the
+// mask cannot be read or there is none.
+static int allowed_cpus(int cpus[POOL_MAX_CPUS]) {
+#ifdef __linux__
+    cpu_set_t set;
+    int n = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return 0;
+    }
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &set)) {
+            cpus[n++] = c;
+        }
+    }
+    return n;
+#else
+    (void)cpus;
+    return 0;
+#endif
+}
+
+// Returns 0, or -1 if the thread could not be bound
+static int pin_thread(pthread_t thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    (void)thread;
+    (void)cpu;
+    return 0;
+#endif
+}
+
+KeccakPool *keccak_pool_create(int threads, int pin_cpus) {
+    int cpus[POOL_MAX_CPUS];
+    int allowed = allowed_cpus(cpus);
+
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = allowed > 0 ? allowed : online > 0 ? (int)online : 1;
+    }
+
+    KeccakPool *pool = (KeccakPool*)calloc(1, sizeof(KeccakPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    void *workers = NULL;
+    if (posix_memalign(&workers, 64, (size_t)threads * sizeof(PoolWorker)) != 0) {
+        free(pool);
+        return NULL;
+    }
+    memset(workers, 0, (size_t)threads * sizeof(PoolWorker));
+
+    pool->workers = (PoolWorker*)workers;
+    pool->threads = threads;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (int i = 0; i < threads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+    }
+
+    // Worker 0 is whichever thread calls keccak_pool_hash
+    for (int i = 1; i < threads; i++) {
+        PoolWorker *w = &pool->workers[i];
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            keccak_pool_destroy(pool);
+            return NULL;
+        }
+        pool->started++;
+        if (pin_cpus && allowed > 0 && pin_thread(w->thread, cpus[i % allowed]) != 0) {
+            keccak_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    // The caller last, so a failure above leaves its affinity as it was
+    if (pin_cpus && allowed > 0 && pin_thread(pthread_self(), cpus[0]) != 0) {
+        keccak_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void keccak_pool_destroy(KeccakPool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i <= pool->started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->workers);
+    free(pool);
+}
+
+int keccak_pool_threads(const KeccakPool *pool) {
+    return pool->threads;
+}
+
+// BATCH SUBMISSION
+
+// Run the published job over indices [0, n) and wait for it
+static void pool_run(KeccakPool *pool, uint32_t n) {
+    // Batches of one or two chunks are not worth waking anyone for
+    int threads = pool->threads;
+    if (n <= 2 * POOL_CHUNK) {
+        threads = 1;
+    }
+
+    // Equal initial ranges; stealing evens out uneven message lengths
+    for (int i = 0; i < pool->threads; i++) {
+        uint32_t b = i < threads ? (uint32_t)((uint64_t)n * i / threads) : n;
+        uint32_t e = i < threads ? (uint32_t)((uint64_t)n * (i + 1) / threads) : n;
+        __atomic_store_n(&pool->workers[i].range, range_pack(b, e), __ATOMIC_RELAXED);
+    }
+
+    if (threads > 1) {
+        pthread_mutex_lock(&pool->lock);
+        pool->pending = threads - 1;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    worker_run(&pool->workers[0]);
+
+    // Every worker must have left the job before its fields are reused
+    if (threads > 1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->pending > 0) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void keccak_pool_hash(KeccakPool *pool, const uint8_t *const *msgs, const size_t *lens, size_t n,
+                      const PreparedSchedule *prepared, uint8_t (*digests)[KECCAK_POOL_DIGEST]) {
+    pool->fn = NULL;
+    pool->prepared = prepared;
+    while (n > 0) {
+        uint32_t slice = n > POOL_MAX_BATCH ? POOL_MAX_BATCH : (uint32_t)n;
+        pool->msgs = msgs;
+        pool->lens = lens;
+        pool->digests = digests;
+        pool_run(pool, slice);
+        msgs += slice;
+        lens += slice;
+        digests += slice;
+        n -= slice;
+    }
+}
+
+void keccak_pool_run(KeccakPool *pool, size_t n, keccak_pool_fn fn, void *ctx) {
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->base = 0;
+    while (n > 0) {
+        uint32_t slice = n > POOL_MAX_BATCH ? POOL_MAX_BATCH : (uint32_t)n;
+        pool_run(pool, slice);
+        pool->base += slice;
+        n -= slice;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef KECCAK_POOL_H
+#define KECCAK_POOL_H
+
+#include <stddef.h>
+#include "keccak_sponge.h"
+
+// Digest size produced by the batch hashing engine (SHA3-256 sized)
+#define KECCAK_POOL_DIGEST 32
+
+// Multi-core batch hashing engine. A fixed set of worker threads, each with
+// its own state arena (sponge, schedule, seed buffer), hashes the messages
+// of a batch in parallel. Every worker owns a range of message indices and
+// takes fixed-size chunks from its front; a worker that runs dry steals the
+// back half of another worker's range. Ranges are single 64-bit words
+// updated with compare-and-swap, so no lock is taken while work remains.
+typedef struct KeccakPool KeccakPool;
+
+// Job callback of keccak_pool_run: process indices [begin, end) of the job
+// described by ctx. Called from every worker at once, on disjoint ranges.
+typedef void (*keccak_pool_fn)(void *ctx, size_t begin, size_t end);
+
+// Create a pool of `threads` workers (<= 0 means one per CPU the calling
+// thread may run on). The calling thread of keccak_pool_hash counts as one
+// of them. With pin_cpus set, worker i is bound to the i-th CPU of the
+// caller's affinity mask (wrapping around), and the calling thread itself,
+// which should be the one submitting, to the first (Linux only; ignored
+// elsewhere). Returns NULL on allocation, thread creation or, with pin_cpus,
+// binding failure.
+KeccakPool *keccak_pool_create(int threads, int pin_cpus);
+
+// Stop the workers and release the pool
+void keccak_pool_destroy(KeccakPool *pool);
+
+// Number of workers, including the calling thread
+int keccak_pool_threads(const KeccakPool *pool);
+
+// Hash n messages; digests[j] belongs to msgs[j].
+// With prepared == NULL each message uses its own plaintext-mode schedule
+// (seeded from SHA256(DOMAIN_SEPARATOR_MSG || msg)); otherwise all messages
+// share the prepared schedule (MODE_KEY). Blocks until every digest is
+// written. Only one thread may submit to a pool at a time.
+void keccak_pool_hash(KeccakPool *pool, const uint8_t *const *msgs, const size_t *lens, size_t n,
+                      const PreparedSchedule *prepared, uint8_t (*digests)[KECCAK_POOL_DIGEST]);
+
+// Run fn over the indices [0, n), split across the workers like a message
+// batch: chunks of 16 from each worker's own range, then stolen halves.
+// Blocks until every call has returned. Only one thread may submit to a
+// pool at a time. Tree leaves (keccak_tree.h) and counter-mode XOF blocks
+// (keccak_xof.h) are run this way.
+void keccak_pool_run(KeccakPool *pool, size_t n, keccak_pool_fn fn, void *ctx);
+
+#endif // KECCAK_POOL_H
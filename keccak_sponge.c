@@ -0,0 +1,123 @@
+#include <string.h>
+
+#include "keccak_sponge.h"
+
+// BYTE ACCESS
+
+static inline void xor_byte(u64 state[25], size_t pos, uint8_t b) {
+    state[pos / 8] ^= (u64)b << (8 * (pos % 8));
+}
+
+// INITIALIZATION
+
+void keccak_sponge_init_prepared(KeccakSponge *ctx, const PreparedSchedule *prepared) {
+    memset(ctx->state, 0, sizeof(ctx->state));
+    ctx->prepared = *prepared;
+    ctx->pos = 0;
+    ctx->squeezing = 0;
+}
+
+int keccak_sponge_init(KeccakSponge *ctx, const KeccakSchedule *schedule) {
+    PreparedSchedule prepared;
+
+    if (keccak_prepare_schedule(schedule, &prepared) != 0) {
+        return -1;
+    }
+    keccak_sponge_init_prepared(ctx, &prepared);
+    return 0;
+}
+
+// ABSORB
+
+int keccak_sponge_update(KeccakSponge *ctx, const uint8_t *data, size_t len) {
+    if (ctx->squeezing) {
+        return -1;
+    }
+
+    // Top up a block left partially filled by the previous call
+    if (ctx->pos != 0) {
+        while (len > 0 && ctx->pos < KECCAK_SPONGE_RATE) {
+            xor_byte(ctx->state, ctx->pos++, *data++);
+            len--;
+        }
+        if (ctx->pos < KECCAK_SPONGE_RATE) {
+            return 0;
+        }
+        keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+        ctx->pos = 0;
+    }
+
+    // Whole blocks go from the caller's buffer straight into the rate lanes
+    while (len >= KECCAK_SPONGE_RATE) {
+        for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+            ctx->state[i] ^= load64_le(data + 8 * i);
+        }
+        keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+        data += KECCAK_SPONGE_RATE;
+        len -= KECCAK_SPONGE_RATE;
+    }
+
+    // The tail stays XORed into the state until the next call or final
+    while (len > 0) {
+        xor_byte(ctx->state, ctx->pos++, *data++);
+        len--;
+    }
+    return 0;
+}
+
+void keccak_sponge_final_pad(KeccakSponge *ctx, uint8_t pad) {
+    if (ctx->squeezing) {
+        return;
+    }
+
+    // pad10*1: domain bits after the message, final '1' in the last rate byte
+    xor_byte(ctx->state, ctx->pos, pad);
+    xor_byte(ctx->state, KECCAK_SPONGE_RATE - 1, 0x80);
+    keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+
+    ctx->pos = 0;
+    ctx->squeezing = 1;
+}
+
+void keccak_sponge_final(KeccakSponge *ctx) {
+    keccak_sponge_final_pad(ctx, KECCAK_SPONGE_PAD);
+}
+
+// SQUEEZE
+
+void keccak_sponge_squeeze(KeccakSponge *ctx, uint8_t *out, size_t len) {
+    keccak_sponge_final(ctx);
+
+    while (len > 0) {
+        if (ctx->pos == KECCAK_SPONGE_RATE) {
+            keccak_f_poly_prepared(ctx->state, &ctx->prepared);
+            ctx->pos = 0;
+        }
+
+        // Whole lanes are stored directly while the output is lane-aligned
+        if (ctx->pos % 8 == 0 && len >= 8) {
+            store64_le(out, ctx->state[ctx->pos / 8]);
+            ctx->pos += 8;
+            out += 8;
+            len -= 8;
+        } else {
+            *out++ = (uint8_t)(ctx->state[ctx->pos / 8] >> (8 * (ctx->pos % 8)));
+            ctx->pos++;
+            len--;
+        }
+    }
+}
+
+// ONE-SHOT
+
+int keccak_sponge_hash(const KeccakSchedule *schedule, const uint8_t *data, size_t len,
+                       uint8_t *out, size_t out_len) {
+    KeccakSponge ctx;
+
+    if (keccak_sponge_init(&ctx, schedule) != 0) {
+        return -1;
+    }
+    keccak_sponge_update(&ctx, data, len);
+    keccak_sponge_squeeze(&ctx, out, out_len);
+    return 0;
+}
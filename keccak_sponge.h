@@ -0,0 +1,71 @@
+#ifndef KECCAK_SPONGE_H
+#define KECCAK_SPONGE_H
+
+#include <stddef.h>
+#include "keccak_engine.h"
+
+// Rate of the SHA3-256 parameter set used throughout the project
+// (1088 bits, 17 lanes); the remaining 8 lanes are the capacity.
+#define KECCAK_SPONGE_RATE  136
+#define KECCAK_SPONGE_LANES (KECCAK_SPONGE_RATE / 8)
+
+// SHA3 domain bits '01' plus the first padding '1' (see apply_sha3_padding)
+#define KECCAK_SPONGE_PAD 0x06
+
+// Lanes are little-endian: byte j of a lane sits at bits 8j..8j+7, the same
+// layout init_state_from_message uses. The byte loops compile to plain
+// loads and stores on little-endian targets.
+static inline u64 load64_le(const uint8_t *p) {
+    u64 v = 0;
+    for (int j = 0; j < 8; j++) {
+        v |= (u64)p[j] << (8 * j);
+    }
+    return v;
+}
+
+static inline void store64_le(uint8_t *p, u64 v) {
+    for (int j = 0; j < 8; j++) {
+        p[j] = (uint8_t)(v >> (8 * j));
+    }
+}
+
+// Incremental sponge over the polymorphic permutation.
+// Input is XORed into the rate lanes straight from the caller's buffer and
+// the prepared schedule runs after every full block, so the context is the
+// only memory used whatever the message length. Nothing is heap-allocated.
+typedef struct {
+    u64 state[25];
+    PreparedSchedule prepared;
+    size_t pos;          // bytes absorbed into / squeezed from the current block
+    int squeezing;       // 0 while absorbing, 1 once padding has been applied
+} KeccakSponge;
+
+// Start a sponge under a schedule.
+// Returns 0 on success, -1 if the schedule holds an invalid step or variant.
+int keccak_sponge_init(KeccakSponge *ctx, const KeccakSchedule *schedule);
+
+// Start a sponge under an already prepared schedule (copied into ctx)
+void keccak_sponge_init_prepared(KeccakSponge *ctx, const PreparedSchedule *prepared);
+
+// Absorb len bytes; may be called any number of times with any split.
+// Returns 0, or -1 if the sponge has already been finalized.
+int keccak_sponge_update(KeccakSponge *ctx, const uint8_t *data, size_t len);
+
+// Apply pad10*1 with the SHA3 domain bits and switch to squeezing.
+// Calling it again has no effect.
+void keccak_sponge_final(KeccakSponge *ctx);
+
+// Same with other domain bits: pad holds them followed by the first '1' of
+// pad10*1, as KECCAK_SPONGE_PAD does (used by the tree mode, keccak_tree.h)
+void keccak_sponge_final_pad(KeccakSponge *ctx, uint8_t pad);
+
+// Squeeze len bytes of output; may be called repeatedly to extend the output.
+// Finalizes the sponge first if keccak_sponge_final was not called.
+void keccak_sponge_squeeze(KeccakSponge *ctx, uint8_t *out, size_t len);
+
+// One-shot hash of a buffer under a schedule.
+// Returns 0 on success, -1 if the schedule is invalid.
+int keccak_sponge_hash(const KeccakSchedule *schedule, const uint8_t *data, size_t len,
+                       uint8_t *out, size_t out_len);
+
+#endif // KECCAK_SPONGE_H
@@ -0,0 +1,83 @@
+// Compile-time specialized permutations for schedules known at build time.
+//
+// A fixed schedule is written as an X-macro MY_SCHEDULE(ROUND) expanding to
+// one ROUND(round, order, theta, rhopi, chi, iota) entry per round, with
+// order 0 = θ first and 1 = ρπ first and every value a plain integer literal
+// (see KECCAK_SCHEDULE_CANONICAL below). Then
+//
+//     KECCAK_DEFINE_STATIC_PERMUTATION(my_permutation, MY_SCHEDULE)
+//
+// defines `static void my_permutation(u64 A[25])`: all rounds inlined
+// into one straight-line function, with every lane index, rotation amount
+// and round constant folded to an immediate. No schedule is read at run
+// time. The schedule is checked at compile time (rounds listed in
+// ascending order, each once; variants in range). A reduced-round schedule
+// lists only the last rounds, e.g. rounds 12..23 for a 12-round
+// permutation, as in Keccak-p[1600, n]. print_schedule_static() prints a
+// runtime schedule, e.g. one derived from a fixed key, in this form.
+//
+// Each permutation inlines roughly 24 round kernels of code, so this is
+// meant for a handful of fixed schedules, not for every key.
+
+#ifndef KECCAK_STATIC_H
+#define KECCAK_STATIC_H
+
+#include "keccak_variants_impl.h"
+#include "seed_generation.h"
+
+// One round, fully specialized. Same step sequence as the ROUND_KERNELS of
+// keccak_engine.c: θ-first rounds ping-pong through B, ρπ-first rounds
+// permute in place.
+#define KECCAK_STATIC_ROUND(r, O, T, R, C, I)                                \
+    if ((O) == 0) {                                                          \
+        theta_v##T##_impl(A);                                                \
+        rhopi_v##R##_to_impl(B, A);                                          \
+        chi_v##C##_impl(A, B);                                               \
+    } else {                                                                 \
+        rhopi_v##R##_impl(A);                                                \
+        theta_v##T##_impl(A);                                                \
+        chi_v##C##_impl(A, A);                                               \
+    }                                                                        \
+    A[0] ^= IOTA_RC[I][r];
+
+// Compile-time schedule checks
+#define KECCAK_STATIC_ROUND_COUNT(r, O, T, R, C, I) + 1
+#define KECCAK_STATIC_ROUND_VALID(r, O, T, R, C, I) \
+    && (r) >= 0 && (r) < KECCAK_ROUNDS_FULL && ((O) == 0 || (O) == 1) && \
+    (T) >= 0 && (T) < 7 && (R) >= 0 && (R) < 7 && (C) >= 0 && (C) < 7 && (I) >= 0 && (I) < 7
+
+// Round order: the entries expand to the chain
+//     FULL - n == r0 && r0 + 1 == r1 && ... && r(n-1) + 1 == FULL
+// which holds only for rounds FULL - n .. FULL - 1 listed in ascending order
+#define KECCAK_STATIC_ROUND_NEXT(r, O, T, R, C, I) == (r) && (r) + 1
+
+#define KECCAK_DEFINE_STATIC_PERMUTATION(name, SCHEDULE)                     \
+    KECCAK_STATIC_ASSERT((1 SCHEDULE(KECCAK_STATIC_ROUND_VALID)) &&          \
+                         (0 SCHEDULE(KECCAK_STATIC_ROUND_COUNT)) >= 1 &&     \
+                         (KECCAK_ROUNDS_FULL - (0 SCHEDULE(KECCAK_STATIC_ROUND_COUNT)) \
+                          SCHEDULE(KECCAK_STATIC_ROUND_NEXT) == KECCAK_ROUNDS_FULL), \
+                         name##_schedule_is_valid);                          \
+    static void name(u64 A[25]) {                                            \
+        u64 B[25];                                                           \
+        SCHEDULE(KECCAK_STATIC_ROUND)                                        \
+    }
+
+// All-V0 θ-first schedule: the standard Keccak-f[1600] permutation
+#define KECCAK_SCHEDULE_CANONICAL(ROUND) \
+    ROUND( 0, 0, 0, 0, 0, 0) ROUND( 1, 0, 0, 0, 0, 0) ROUND( 2, 0, 0, 0, 0, 0) \
+    ROUND( 3, 0, 0, 0, 0, 0) ROUND( 4, 0, 0, 0, 0, 0) ROUND( 5, 0, 0, 0, 0, 0) \
+    ROUND( 6, 0, 0, 0, 0, 0) ROUND( 7, 0, 0, 0, 0, 0) ROUND( 8, 0, 0, 0, 0, 0) \
+    ROUND( 9, 0, 0, 0, 0, 0) ROUND(10, 0, 0, 0, 0, 0) ROUND(11, 0, 0, 0, 0, 0) \
+    ROUND(12, 0, 0, 0, 0, 0) ROUND(13, 0, 0, 0, 0, 0) ROUND(14, 0, 0, 0, 0, 0) \
+    ROUND(15, 0, 0, 0, 0, 0) ROUND(16, 0, 0, 0, 0, 0) ROUND(17, 0, 0, 0, 0, 0) \
+    ROUND(18, 0, 0, 0, 0, 0) ROUND(19, 0, 0, 0, 0, 0) ROUND(20, 0, 0, 0, 0, 0) \
+    ROUND(21, 0, 0, 0, 0, 0) ROUND(22, 0, 0, 0, 0, 0) ROUND(23, 0, 0, 0, 0, 0)
+
+// Its last KECCAK_ROUNDS_FAST rounds: Keccak-p[1600, 12] of TurboSHAKE / K12
+#define KECCAK_SCHEDULE_CANONICAL_FAST(ROUND) \
+    ROUND(12, 0, 0, 0, 0, 0) ROUND(13, 0, 0, 0, 0, 0) ROUND(14, 0, 0, 0, 0, 0) \
+    ROUND(15, 0, 0, 0, 0, 0) ROUND(16, 0, 0, 0, 0, 0) ROUND(17, 0, 0, 0, 0, 0) \
+    ROUND(18, 0, 0, 0, 0, 0) ROUND(19, 0, 0, 0, 0, 0) ROUND(20, 0, 0, 0, 0, 0) \
+    ROUND(21, 0, 0, 0, 0, 0) ROUND(22, 0, 0, 0, 0, 0) ROUND(23, 0, 0, 0, 0, 0)
+
+#endif // KECCAK_STATIC_H
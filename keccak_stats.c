@@ -0,0 +1,355 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // clock_gettime, posix_memalign under -std=c99
+#elif !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "keccak_stats.h"
+
+static const char *const STEP_NAMES[4] = {"theta", "rhopi", "chi", "iota"};
+
+#ifdef KECCAK_STATS
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Synchronization uses the GCC/Clang __atomic builtins, which are available
+// in C99 mode (unlike <stdatomic.h>).
+
+// THREAD SLOTS
+
+// One thread's counters, on cache lines of their own. Only the owning
+// thread writes them; snapshots read them with relaxed loads.
+typedef struct StatsSlot {
+    KeccakStats counters;
+    struct StatsSlot *next;   // list of every slot, never unlinked
+    int in_use;               // owned by a live thread
+} __attribute__((aligned(64))) StatsSlot;
+
+static StatsSlot *slot_list;
+static __thread StatsSlot *thread_slot;
+static pthread_key_t slot_key;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static uint64_t timer_overhead;     // cycles of an empty START / stop pair
+
+// Thread exit: the slot keeps its counts and goes back for reuse
+static void release_slot(void *p) {
+    __atomic_store_n(&((StatsSlot*)p)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+// The cheapest of many back-to-back timer reads: what a sample costs with
+// nothing between them
+static uint64_t calibrate_timer(void) {
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = keccak_stats_cycles();
+        uint64_t cycles = keccak_stats_cycles() - start;
+
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    return best;
+}
+
+static void init_stats(void) {
+    pthread_key_create(&slot_key, release_slot);
+    timer_overhead = calibrate_timer();
+}
+
+// First use in a thread: take a released slot, or push a new one
+static StatsSlot *acquire_slot(void) {
+    StatsSlot *slot;
+
+    pthread_once(&init_once, init_stats);
+    for (slot = __atomic_load_n(&slot_list, __ATOMIC_ACQUIRE); slot; slot = slot->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&slot->in_use, &expected, 1, 0, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (slot == NULL) {
+        void *memory = NULL;
+        if (posix_memalign(&memory, 64, sizeof(StatsSlot)) != 0) {
+            return NULL;
+        }
+        slot = (StatsSlot*)memory;
+        memset(slot, 0, sizeof(*slot));
+        slot->in_use = 1;
+        slot->next = __atomic_load_n(&slot_list, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&slot_list, &slot->next, slot, 1, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(slot_key, slot);
+    thread_slot = slot;
+    return slot;
+}
+
+static inline KeccakStats *thread_counters(void) {
+    StatsSlot *slot = thread_slot;
+
+    if (__builtin_expect(slot == NULL, 0) && (slot = acquire_slot()) == NULL) {
+        return NULL;
+    }
+    return &slot->counters;
+}
+
+// Single writer: a relaxed load and store, so readers never see a torn value
+static inline void add(uint64_t *counter, uint64_t v) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+}
+
+// RECORDING
+
+// A sample less the timer's own cost. Every thread has passed init_stats
+// (through acquire_slot) before it records.
+static inline uint64_t net(uint64_t cycles) {
+    return cycles > timer_overhead ? cycles - timer_overhead : 0;
+}
+
+#if !(defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+uint64_t keccak_stats_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static void count_schedule(KeccakStats *c, const PreparedSchedule *prepared, uint64_t states) {
+    add(&c->rounds, states * (uint64_t)prepared->num_rounds);
+    for (int r = 0; r < prepared->num_rounds; r++) {
+        add(&c->swapped_rounds, states * prepared->order[r]);
+        add(&c->variant_hits[STEP_THETA][prepared->theta[r]], states);
+        add(&c->variant_hits[STEP_RHOPI][prepared->rhopi[r]], states);
+        add(&c->variant_hits[STEP_CHI][prepared->chi[r]], states);
+        add(&c->variant_hits[STEP_IOTA][prepared->iota[r]], states);
+    }
+}
+
+void keccak_stats_permutation(const PreparedSchedule *prepared, uint64_t states, uint64_t cycles) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL || states == 0) {
+        return;
+    }
+    add(&c->permutations, states);
+    add(&c->permutation_cycles, net(cycles));
+    if (prepared) {
+        count_schedule(c, prepared, states);
+    }
+}
+
+void keccak_stats_round(int swapped) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL) {
+        return;
+    }
+    add(&c->rounds, 1);
+    add(&c->swapped_rounds, swapped ? 1 : 0);
+}
+
+void keccak_stats_step(int step, int variant, uint64_t cycles) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL) {
+        return;
+    }
+    add(&c->variant_hits[step][variant], 1);
+    add(&c->step_calls[step], 1);
+    add(&c->step_cycles[step], net(cycles));
+}
+
+void keccak_stats_fused(int rhopi, int chi, uint64_t cycles) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL) {
+        return;
+    }
+    add(&c->variant_hits[STEP_RHOPI][rhopi], 1);
+    add(&c->variant_hits[STEP_CHI][chi], 1);
+    add(&c->fused_calls, 1);
+    add(&c->fused_cycles, net(cycles));
+}
+
+void keccak_stats_sha256(uint64_t blocks, uint64_t cycles) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL || blocks == 0) {
+        return;
+    }
+    add(&c->sha256_blocks, blocks);
+    add(&c->sha256_cycles, net(cycles));
+}
+
+void keccak_stats_schedule(uint64_t aes_cycles) {
+    KeccakStats *c = thread_counters();
+
+    if (c == NULL) {
+        return;
+    }
+    add(&c->schedules, 1);
+    add(&c->aes_cycles, net(aes_cycles));
+}
+
+// SNAPSHOT
+
+int keccak_stats_enabled(void) {
+    return 1;
+}
+
+void keccak_stats_snapshot(KeccakStats *stats) {
+    const size_t words = sizeof(KeccakStats) / sizeof(uint64_t);
+    uint64_t *total = (uint64_t*)stats;
+
+    memset(stats, 0, sizeof(*stats));
+    for (StatsSlot *slot = __atomic_load_n(&slot_list, __ATOMIC_ACQUIRE); slot;
+         slot = slot->next) {
+        uint64_t *counters = (uint64_t*)&slot->counters;
+        for (size_t i = 0; i < words; i++) {
+            total[i] += __atomic_load_n(&counters[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#else
+
+int keccak_stats_enabled(void) {
+    return 0;
+}
+
+void keccak_stats_snapshot(KeccakStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // KECCAK_STATS
+
+// EXPORT
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;         // full length, even past size
+} Output;
+
+static void emit(Output *out, const char *format, ...) {
+    // Once truncated, later text is only measured; vsnprintf has already
+    // terminated what fits
+    char *at = out->len < out->size ? out->buf + out->len : NULL;
+    size_t room = out->len < out->size ? out->size - out->len : 0;
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(at, room, format, args);
+    va_end(args);
+    if (n > 0) {
+        out->len += (size_t)n;
+    }
+}
+
+static void prometheus_counter(Output *out, const char *name, const char *help, uint64_t value) {
+    emit(out, "# HELP polymtd_%s_total %s\n# TYPE polymtd_%s_total counter\n", name, help, name);
+    emit(out, "polymtd_%s_total %llu\n", name, (unsigned long long)value);
+}
+
+size_t keccak_stats_prometheus(const KeccakStats *stats, char *buf, size_t size) {
+    Output out = {buf, size, 0};
+
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+    prometheus_counter(&out, "permutations", "States permuted", stats->permutations);
+    prometheus_counter(&out, "permutation_cycles", "Cycles spent in permutations",
+                       stats->permutation_cycles);
+    prometheus_counter(&out, "rounds", "Rounds run", stats->rounds);
+    prometheus_counter(&out, "swapped_rounds", "Rounds running rho-pi before theta",
+                       stats->swapped_rounds);
+
+    emit(&out, "# HELP polymtd_variant_hits_total Rounds run per step variant\n"
+               "# TYPE polymtd_variant_hits_total counter\n");
+    for (int s = 0; s < 4; s++) {
+        for (int v = 0; v < KECCAK_VARIANTS; v++) {
+            emit(&out, "polymtd_variant_hits_total{step=\"%s\",variant=\"%d\"} %llu\n",
+                 STEP_NAMES[s], v, (unsigned long long)stats->variant_hits[s][v]);
+        }
+    }
+
+    emit(&out, "# HELP polymtd_step_calls_total Steps timed on their own\n"
+               "# TYPE polymtd_step_calls_total counter\n");
+    for (int s = 0; s < 4; s++) {
+        emit(&out, "polymtd_step_calls_total{step=\"%s\"} %llu\n", STEP_NAMES[s],
+             (unsigned long long)stats->step_calls[s]);
+    }
+    emit(&out, "# HELP polymtd_step_cycles_total Cycles of the steps timed on their own\n"
+               "# TYPE polymtd_step_cycles_total counter\n");
+    for (int s = 0; s < 4; s++) {
+        emit(&out, "polymtd_step_cycles_total{step=\"%s\"} %llu\n", STEP_NAMES[s],
+             (unsigned long long)stats->step_cycles[s]);
+    }
+    prometheus_counter(&out, "rhopi_chi_calls", "Fused rho-pi + chi kernels timed",
+                       stats->fused_calls);
+    prometheus_counter(&out, "rhopi_chi_cycles", "Cycles of the fused rho-pi + chi kernels",
+                       stats->fused_cycles);
+
+    prometheus_counter(&out, "sha256_blocks", "SHA-256 blocks compressed", stats->sha256_blocks);
+    prometheus_counter(&out, "sha256_cycles", "Cycles spent compressing SHA-256 blocks",
+                       stats->sha256_cycles);
+    prometheus_counter(&out, "schedules", "Schedules generated", stats->schedules);
+    prometheus_counter(&out, "aes_cycles", "Cycles spent in schedule AES-CTR expansion",
+                       stats->aes_cycles);
+    return out.len;
+}
+
+static void json_steps(Output *out, const char *name, const uint64_t values[4]) {
+    emit(out, "  \"%s\": {", name);
+    for (int s = 0; s < 4; s++) {
+        emit(out, "%s\"%s\": %llu", s ? ", " : "", STEP_NAMES[s],
+             (unsigned long long)values[s]);
+    }
+    emit(out, "},\n");
+}
+
+size_t keccak_stats_json(const KeccakStats *stats, char *buf, size_t size) {
+    Output out = {buf, size, 0};
+
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+    emit(&out, "{\n  \"enabled\": %s,\n", keccak_stats_enabled() ? "true" : "false");
+    emit(&out, "  \"permutations\": %llu,\n", (unsigned long long)stats->permutations);
+    emit(&out, "  \"permutation_cycles\": %llu,\n",
+         (unsigned long long)stats->permutation_cycles);
+    emit(&out, "  \"rounds\": %llu,\n", (unsigned long long)stats->rounds);
+    emit(&out, "  \"swapped_rounds\": %llu,\n", (unsigned long long)stats->swapped_rounds);
+
+    emit(&out, "  \"variant_hits\": {");
+    for (int s = 0; s < 4; s++) {
+        emit(&out, "%s\"%s\": [", s ? ", " : "", STEP_NAMES[s]);
+        for (int v = 0; v < KECCAK_VARIANTS; v++) {
+            emit(&out, "%s%llu", v ? ", " : "", (unsigned long long)stats->variant_hits[s][v]);
+        }
+        emit(&out, "]");
+    }
+    emit(&out, "},\n");
+    json_steps(&out, "step_calls", stats->step_calls);
+    json_steps(&out, "step_cycles", stats->step_cycles);
+    emit(&out, "  \"rhopi_chi_calls\": %llu,\n", (unsigned long long)stats->fused_calls);
+    emit(&out, "  \"rhopi_chi_cycles\": %llu,\n", (unsigned long long)stats->fused_cycles);
+
+    emit(&out, "  \"sha256_blocks\": %llu,\n", (unsigned long long)stats->sha256_blocks);
+    emit(&out, "  \"sha256_cycles\": %llu,\n", (unsigned long long)stats->sha256_cycles);
+    emit(&out, "  \"schedules\": %llu,\n", (unsigned long long)stats->schedules);
+    emit(&out, "  \"aes_cycles\": %llu\n}\n", (unsigned long long)stats->aes_cycles);
+    return out.len;
+}
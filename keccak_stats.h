@@ -0,0 +1,121 @@
+#ifndef KECCAK_STATS_H
+#define KECCAK_STATS_H
+
+#include <stddef.h>
+#include "keccak_engine.h"
+
+// Execution statistics of the schedule engine and the seed derivation,
+// compiled in with -DKECCAK_STATS (the whole library must be built with
+// it: PreparedSchedule gains the iota selectors). Without it every hook
+// below expands to nothing, so the hot paths are the same code as an
+// uninstrumented build; the snapshot and export functions still exist and
+// report zeros.
+//
+// Each thread counts into its own cache-line-aligned slot, written only by
+// that thread, so recording takes no lock and no atomic read-modify-write.
+// keccak_stats_snapshot sums the slots without stopping the writers. A slot
+// outlives its thread (and is reused by a later one), so the totals keep
+// the work of threads that have exited.
+//
+// What is counted:
+//   - every permutation through keccak_f_poly_prepared, keccak_f_poly and
+//     the SIMD batch engines (keccak_batch.h), one per state: its rounds,
+//     the rounds running ρπ before θ, the variant of each step per round,
+//     and the cycles spent (TSC on x86);
+//   - cycles per step, in keccak_f_poly, which times each kernel it runs:
+//     θ, ι, and ρπ or χ when they run alone (θ between them) as steps, the
+//     fused ρπ + χ kernel as one sample. It runs the same kernels with and
+//     without KECCAK_STATS. The prepared engine, which most traffic uses,
+//     runs a whole round as one kernel and is timed per permutation only:
+//     its cost per round is permutation_cycles / rounds;
+//   - SHA-256 blocks compressed and their cycles: single-stream calls
+//     (seed derivations and any other sha256_* use) per call, multi-buffer
+//     sha256_batch calls (pool plaintext hashing, generate_schedules_batch)
+//     per batch, and the cycles of the AES-CTR expansion of every
+//     generated schedule.
+// Permutations generated by keccak_static.h are not counted.
+//
+// Every timed sample has the cost of the timer itself (a pair of rdtsc,
+// about as long as a short step) measured once at startup and subtracted,
+// so short samples are not dominated by the instrumentation. What remains
+// still includes the pipeline effects of the timer around small kernels;
+// read per-step cycles as relative costs.
+
+// Counter totals. variant_hits[step][v] counts the rounds that ran variant
+// v of step (STEP_THETA .. STEP_IOTA).
+typedef struct {
+    uint64_t permutations;
+    uint64_t permutation_cycles;
+    uint64_t rounds;
+    uint64_t swapped_rounds;                    // ρπ before θ
+    uint64_t variant_hits[4][KECCAK_VARIANTS];
+    uint64_t step_calls[4];                     // keccak_f_poly only
+    uint64_t step_cycles[4];
+    uint64_t fused_calls;                       // ρπ + χ as one kernel, keccak_f_poly
+    uint64_t fused_cycles;
+    uint64_t sha256_blocks;
+    uint64_t sha256_cycles;
+    uint64_t schedules;                         // generate_schedule_internal
+    uint64_t aes_cycles;
+} KeccakStats;
+
+// 1 if the library was built with KECCAK_STATS
+int keccak_stats_enabled(void);
+
+// Sum of every thread's counters. Counters still being written may be
+// caught mid-update by a few operations, never torn.
+void keccak_stats_snapshot(KeccakStats *stats);
+
+// Prometheus text exposition (counters named polymtd_*_total) and a JSON
+// object of the same counters. Both write at most size bytes including the
+// terminator and return the full length, as snprintf does.
+size_t keccak_stats_prometheus(const KeccakStats *stats, char *buf, size_t size);
+size_t keccak_stats_json(const KeccakStats *stats, char *buf, size_t size);
+
+#ifdef KECCAK_STATS
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+static inline uint64_t keccak_stats_cycles(void) {
+    return __builtin_ia32_rdtsc();
+}
+#else
+// Nanoseconds where there is no TSC
+uint64_t keccak_stats_cycles(void);
+#endif
+
+// Recording entry points, called through the macros below. A NULL
+// prepared schedule counts the permutations and cycles only (keccak_f_poly
+// records its rounds and steps one by one).
+void keccak_stats_permutation(const PreparedSchedule *prepared, uint64_t states, uint64_t cycles);
+void keccak_stats_round(int swapped);
+void keccak_stats_step(int step, int variant, uint64_t cycles);
+void keccak_stats_fused(int rhopi, int chi, uint64_t cycles);
+void keccak_stats_sha256(uint64_t blocks, uint64_t cycles);
+void keccak_stats_schedule(uint64_t aes_cycles);
+
+#define KECCAK_STATS_ONLY(x) x
+#define KECCAK_STATS_START(t) uint64_t t = keccak_stats_cycles()
+#define KECCAK_STATS_PERMUTATION(prepared, states, t) \
+    keccak_stats_permutation(prepared, states, keccak_stats_cycles() - (t))
+#define KECCAK_STATS_ROUND(swapped) keccak_stats_round(swapped)
+#define KECCAK_STATS_STEP(step, variant, t) \
+    keccak_stats_step(step, variant, keccak_stats_cycles() - (t))
+#define KECCAK_STATS_FUSED(rhopi, chi, t) \
+    keccak_stats_fused(rhopi, chi, keccak_stats_cycles() - (t))
+#define KECCAK_STATS_SHA256(blocks, t) keccak_stats_sha256(blocks, keccak_stats_cycles() - (t))
+#define KECCAK_STATS_SCHEDULE(t) keccak_stats_schedule(keccak_stats_cycles() - (t))
+
+#else
+
+#define KECCAK_STATS_ONLY(x)
+#define KECCAK_STATS_START(t) ((void)0)
+#define KECCAK_STATS_PERMUTATION(prepared, states, t) ((void)0)
+#define KECCAK_STATS_ROUND(swapped) ((void)0)
+#define KECCAK_STATS_STEP(step, variant, t) ((void)0)
+#define KECCAK_STATS_FUSED(rhopi, chi, t) ((void)0)
+#define KECCAK_STATS_SHA256(blocks, t) ((void)0)
+#define KECCAK_STATS_SCHEDULE(t) ((void)0)
+
+#endif // KECCAK_STATS
+
+#endif // KECCAK_STATS_H
@@ -0,0 +1,184 @@
+#include <string.h>
+
+#include "keccak_trace.h"
+
+static const keccak_step_fn *const STEP_TABLES[3] = {
+    THETA_VARIANTS, RHOPI_VARIANTS, CHI_VARIANTS
+};
+
+// RECORDS
+
+static void put(KeccakTrace *trace, const uint8_t *bytes, size_t len) {
+    if (!trace->error && fwrite(bytes, 1, len, trace->out) != len) {
+        trace->error = 1;
+    }
+}
+
+// Write head (the record type and its fixed fields) and the delta between
+// before and after as one record
+static void put_delta(KeccakTrace *trace, const uint8_t *head, size_t head_len,
+                      const u64 before[25], const u64 after[25]) {
+    uint8_t rec[4 + 4 + 25 * 8];
+    uint32_t mask = 0;
+    size_t len = head_len + 4;
+
+    memcpy(rec, head, head_len);
+    for (int i = 0; i < 25; i++) {
+        u64 diff = before[i] ^ after[i];
+
+        if (diff != 0) {
+            mask |= 1u << i;
+            store64_le(rec + len, diff);
+            len += 8;
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        rec[head_len + j] = (uint8_t)(mask >> (8 * j));
+    }
+    put(trace, rec, len);
+}
+
+// Bring a reader up to the current state if untraced blocks ran since the
+// last record
+static void put_state(KeccakTrace *trace) {
+    uint8_t head[9] = { KECCAK_TRACE_STATE };
+
+    if (memcmp(trace->written, trace->state, sizeof(trace->state)) == 0) {
+        return;
+    }
+    for (int j = 0; j < 8; j++) {
+        head[1 + j] = (uint8_t)(trace->blocks >> (8 * j));
+    }
+    put_delta(trace, head, 9, trace->written, trace->state);
+    memcpy(trace->written, trace->state, sizeof(trace->state));
+}
+
+// Absorb the buffered block and run the permutation, step by step with
+// records when the block is in the traced range
+static void trace_block(KeccakTrace *trace, int final) {
+    const KeccakSchedule *schedule = &trace->schedule;
+    int first = KECCAK_ROUNDS - schedule->num_rounds;
+    uint8_t head[4] = { KECCAK_TRACE_ABSORB, final ? KECCAK_TRACE_FINAL : 0 };
+    u64 before[25];
+
+    // Unsigned, so blocks before the range wrap past count too
+    if (trace->blocks - trace->first >= trace->count) {
+        for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+            trace->state[i] ^= load64_le(trace->block + 8 * i);
+        }
+        keccak_f_poly_prepared(trace->state, &trace->prepared);
+        trace->blocks++;
+        trace->pos = 0;
+        return;
+    }
+
+    put_state(trace);
+    memcpy(before, trace->state, sizeof(before));
+    for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+        trace->state[i] ^= load64_le(trace->block + 8 * i);
+    }
+    put_delta(trace, head, 2, before, trace->state);
+
+    head[0] = KECCAK_TRACE_STEP;
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        const RoundSchedule *rs = &schedule->rounds[r];
+
+        for (int i = 0; i < 4; i++) {
+            int step = rs->step_order[i];
+            int variant = rs->variants[i];
+
+            memcpy(before, trace->state, sizeof(before));
+            if (step == STEP_IOTA) {
+                IOTA_VARIANTS[variant](trace->state, first + r);
+            } else {
+                STEP_TABLES[step][variant](trace->state);
+            }
+            head[1] = (uint8_t)(first + r);
+            head[2] = (uint8_t)step;
+            head[3] = (uint8_t)variant;
+            put_delta(trace, head, 4, before, trace->state);
+        }
+    }
+    memcpy(trace->written, trace->state, sizeof(trace->state));
+    trace->blocks++;
+    trace->pos = 0;
+}
+
+// API
+
+int keccak_trace_header(FILE *out) {
+    uint8_t header[KECCAK_TRACE_HEADER] = { 0 };
+
+    memcpy(header, KECCAK_TRACE_MAGIC, 8);
+    header[8] = KECCAK_TRACE_VERSION;
+    header[10] = (uint8_t)KECCAK_SPONGE_RATE;
+    header[11] = (uint8_t)(KECCAK_SPONGE_RATE >> 8);
+    return fwrite(header, 1, sizeof(header), out) == sizeof(header) ? 0 : -1;
+}
+
+int keccak_trace_start(KeccakTrace *trace, FILE *out, const KeccakSchedule *schedule) {
+    uint8_t rec[1 + SCHEDULE_PACK_SERIAL + 32];
+    PackedSchedule packed;
+
+    // Packing checks the schedule as keccak_prepare_schedule would
+    if (schedule_pack(schedule, &packed) != 0) {
+        return -1;
+    }
+    memset(trace, 0, sizeof(*trace));
+    trace->out = out;
+    trace->schedule = *schedule;
+    keccak_prepare_schedule(schedule, &trace->prepared);
+    trace->count = UINT64_MAX;
+
+    rec[0] = KECCAK_TRACE_SCHEDULE;
+    schedule_pack_serialize(&packed, rec + 1);
+    memcpy(rec + 1 + SCHEDULE_PACK_SERIAL, schedule->seed, 32);
+    put(trace, rec, sizeof(rec));
+    return trace->error ? -1 : 0;
+}
+
+void keccak_trace_limit(KeccakTrace *trace, uint64_t first, uint64_t count) {
+    trace->first = first;
+    trace->count = count;
+}
+
+int keccak_trace_update(KeccakTrace *trace, const uint8_t *data, size_t len) {
+    while (len > 0 && !trace->error) {
+        size_t take = KECCAK_SPONGE_RATE - trace->pos;
+
+        if (take > len) {
+            take = len;
+        }
+        memcpy(trace->block + trace->pos, data, take);
+        trace->pos += take;
+        data += take;
+        len -= take;
+        if (trace->pos == KECCAK_SPONGE_RATE) {
+            trace_block(trace, 0);
+        }
+    }
+    return trace->error ? -1 : 0;
+}
+
+int keccak_trace_finish(KeccakTrace *trace, uint8_t *digest, size_t len) {
+    uint8_t rec[2 + KECCAK_SPONGE_RATE];
+
+    if (len > KECCAK_SPONGE_RATE) {
+        return -1;
+    }
+
+    memset(trace->block + trace->pos, 0, KECCAK_SPONGE_RATE - trace->pos);
+    trace->block[trace->pos] ^= KECCAK_SPONGE_PAD;
+    trace->block[KECCAK_SPONGE_RATE - 1] ^= 0x80;
+    trace_block(trace, 1);
+    put_state(trace);
+
+    for (size_t i = 0; i < len; i++) {
+        digest[i] = (uint8_t)(trace->state[i / 8] >> (8 * (i % 8)));
+    }
+    rec[0] = KECCAK_TRACE_OUTPUT;
+    rec[1] = (uint8_t)len;
+    memcpy(rec + 2, digest, len);
+    put(trace, rec, 2 + len);
+    return trace->error ? -1 : 0;
+}
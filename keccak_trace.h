@@ -0,0 +1,98 @@
+#ifndef KECCAK_TRACE_H
+#define KECCAK_TRACE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "keccak_engine.h"
+#include "keccak_sponge.h"
+#include "schedule_pack.h"
+
+// Execution traces: a sponge hash that records every step of every
+// permutation to a stream, for replay in PolyMTD_Keccak_Visualizer.html
+// (or any other reader) without recomputing the variants.
+//
+// A step usually touches a few lanes (ι one, θ and χ all 25 but ρπ moves
+// them), so each record keeps the XOR of the lanes it changed rather than
+// the state. XOR deltas are their own inverse: a reader steps backwards by
+// applying the same record again.
+//
+// File layout, all integers little-endian:
+//     header   "PMTDTRAC", u16 version (KECCAK_TRACE_VERSION), u16 rate
+//              (KECCAK_SPONGE_RATE), u32 reserved 0
+//     records  one type byte, then
+//       SCHEDULE  schedule_pack_serialize form (SCHEDULE_PACK_SERIAL bytes)
+//                 and the 32-byte seed. Starts a hash: the state is zero.
+//       ABSORB    u8 flags (KECCAK_TRACE_FINAL on the padded last block),
+//                 delta of the block XORed into the rate
+//       STEP      u8 round, the index ι runs with (KECCAK_ROUNDS -
+//                 num_rounds .. KECCAK_ROUNDS - 1, so 12 .. 23 for a fast
+//                 schedule), u8 step (STEP_THETA .. STEP_IOTA), u8 variant,
+//                 delta of the step
+//       OUTPUT    u8 length, the digest bytes
+//       STATE     u64 index of the next block (counting from 0, or the
+//                 number of blocks before OUTPUT), delta from the state of
+//                 the last record to the state at that point. Written when
+//                 blocks outside the traced range ran in between.
+//     delta    u32 mask of the changed lanes (bit i = lane i = A[x + 5y]),
+//              then one u64 XOR per set bit, lowest lane first
+// A file may hold several hashes one after the other.
+//
+// Tracing is a separate path: keccak_sponge and the permutation engines
+// are not touched and run at full speed. A traced block is not small:
+// about 15 KB per 136-byte block at 24 rounds (over 100 times the input,
+// and only about a fifth less than a full state per step), since θ and χ
+// change every lane. keccak_trace_limit traces a range of blocks and runs
+// the others on the prepared engine without writing them.
+
+#define KECCAK_TRACE_MAGIC   "PMTDTRAC"
+#define KECCAK_TRACE_VERSION 1
+#define KECCAK_TRACE_HEADER  16
+
+enum {
+    KECCAK_TRACE_SCHEDULE = 0x01,
+    KECCAK_TRACE_ABSORB   = 0x02,
+    KECCAK_TRACE_STEP     = 0x03,
+    KECCAK_TRACE_OUTPUT   = 0x04,
+    KECCAK_TRACE_STATE    = 0x05
+};
+
+// ABSORB flags
+#define KECCAK_TRACE_FINAL 0x01
+
+typedef struct {
+    FILE *out;
+    KeccakSchedule schedule;
+    PreparedSchedule prepared;   // runs the blocks outside the range
+    u64 state[25];
+    u64 written[25];     // the state as the records so far leave it
+    uint8_t block[KECCAK_SPONGE_RATE];
+    size_t pos;          // bytes buffered in block
+    uint64_t blocks;     // blocks permuted so far
+    uint64_t first;      // traced blocks: first .. first + count - 1
+    uint64_t count;
+    int error;           // a write failed; later calls do nothing
+} KeccakTrace;
+
+// Write the file header. Once per file, before the first hash.
+// Returns 0, or -1 on a write error.
+int keccak_trace_header(FILE *out);
+
+// Start tracing a hash under a schedule and write its SCHEDULE record.
+// Returns 0, or -1 if the schedule is invalid or the write fails.
+int keccak_trace_start(KeccakTrace *trace, FILE *out, const KeccakSchedule *schedule);
+
+// Trace only count blocks of the hash, from block first (counting from 0;
+// the padded last block counts). Call after keccak_trace_start; by default
+// every block is traced.
+void keccak_trace_limit(KeccakTrace *trace, uint64_t first, uint64_t count);
+
+// Absorb len bytes, writing an ABSORB record and the STEP records of the
+// permutation for every full block in the range. Returns 0, or -1 on a write error.
+int keccak_trace_update(KeccakTrace *trace, const uint8_t *data, size_t len);
+
+// Pad, trace the last block and write the OUTPUT record of a digest of len
+// bytes (at most KECCAK_SPONGE_RATE), the same digest keccak_sponge_hash
+// gives. Returns 0, or -1 on a bad length or a write error.
+int keccak_trace_finish(KeccakTrace *trace, uint8_t *digest, size_t len);
+
+#endif // KECCAK_TRACE_H
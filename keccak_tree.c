@@ -0,0 +1,224 @@
+#include <string.h>
+
+#include "keccak_tree.h"
+#include "keccak_batch.h"
+
+// Leaves hashed in lockstep per SIMD batch call (a multiple of every
+// vector width, and the chunk a pool worker takes at a time)
+#define TREE_GROUP 16
+
+// Whole leaves dispatched at once; their chaining values live on the stack
+#define TREE_BATCH 1024
+
+// A leaf is CHUNK / RATE full blocks plus a tail of whole lanes
+#define TREE_TAIL (KECCAK_TREE_CHUNK % KECCAK_SPONGE_RATE)
+
+#if TREE_TAIL % 8 != 0
+#error "KECCAK_TREE_CHUNK must leave a tail of whole lanes"
+#endif
+
+// Separator between S_0 and the chaining values in the final node
+static const uint8_t TREE_MARKER[8] = {0x03, 0, 0, 0, 0, 0, 0, 0};
+
+// x in big-endian without leading zeros, then the byte count
+static size_t length_encode(uint64_t x, uint8_t out[9]) {
+    size_t n = 0;
+
+    for (uint64_t v = x; v > 0; v >>= 8) {
+        n++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint8_t)(x >> (8 * (n - 1 - i)));
+    }
+    out[n] = (uint8_t)n;
+    return n + 1;
+}
+
+// LEAVES
+
+// count <= TREE_GROUP whole leaves as one structure-of-arrays batch: the
+// same block of every leaf is XORed in, then all states are permuted
+// together. Equivalent to a leaf sponge per chunk.
+static void hash_leaf_group(const PreparedSchedule *prepared, const uint8_t *data, size_t count,
+                            uint8_t (*cvs)[KECCAK_TREE_CV]) {
+    u64 lanes[25 * TREE_GROUP];
+    size_t off = 0;
+
+    memset(lanes, 0, 25 * count * sizeof(u64));
+
+    for (; off + KECCAK_SPONGE_RATE <= KECCAK_TREE_CHUNK; off += KECCAK_SPONGE_RATE) {
+        for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+            for (size_t j = 0; j < count; j++) {
+                lanes[i * count + j] ^= load64_le(data + j * KECCAK_TREE_CHUNK + off + 8 * i);
+            }
+        }
+        keccak_f_poly_batch(lanes, count, prepared);
+    }
+
+    // Tail lanes, then pad10*1 with the leaf domain bits
+    for (int i = 0; i < TREE_TAIL / 8; i++) {
+        for (size_t j = 0; j < count; j++) {
+            lanes[i * count + j] ^= load64_le(data + j * KECCAK_TREE_CHUNK + off + 8 * i);
+        }
+    }
+    for (size_t j = 0; j < count; j++) {
+        lanes[(TREE_TAIL / 8) * count + j] ^= (u64)KECCAK_TREE_PAD_LEAF;
+        lanes[(KECCAK_SPONGE_LANES - 1) * count + j] ^= (u64)0x80 << 56;
+    }
+    keccak_f_poly_batch(lanes, count, prepared);
+
+    for (size_t j = 0; j < count; j++) {
+        for (int i = 0; i < KECCAK_TREE_CV / 8; i++) {
+            store64_le(cvs[j] + 8 * i, lanes[i * count + j]);
+        }
+    }
+}
+
+void keccak_tree_leaves(const PreparedSchedule *prepared, const uint8_t *data, size_t n,
+                        uint8_t (*cvs)[KECCAK_TREE_CV]) {
+    for (size_t j = 0; j < n; j += TREE_GROUP) {
+        size_t count = n - j < TREE_GROUP ? n - j : TREE_GROUP;
+        hash_leaf_group(prepared, data + j * KECCAK_TREE_CHUNK, count, cvs + j);
+    }
+}
+
+// Leaf pass published to the pool workers
+typedef struct {
+    const PreparedSchedule *prepared;
+    const uint8_t *data;
+    uint8_t (*cvs)[KECCAK_TREE_CV];
+} TreeLeavesJob;
+
+static void leaves_range(void *ctx, size_t begin, size_t end) {
+    const TreeLeavesJob *job = (const TreeLeavesJob*)ctx;
+    keccak_tree_leaves(job->prepared, job->data + begin * KECCAK_TREE_CHUNK, end - begin,
+                       job->cvs + begin);
+}
+
+void keccak_pool_tree_leaves(KeccakPool *pool, const uint8_t *data, size_t n,
+                             const PreparedSchedule *prepared, uint8_t (*cvs)[KECCAK_TREE_CV]) {
+    TreeLeavesJob job = {prepared, data, cvs};
+    keccak_pool_run(pool, n, leaves_range, &job);
+}
+
+// Close the leaf sponge and absorb its chaining value into the final node
+static void finish_leaf(KeccakTree *tree) {
+    uint8_t cv[KECCAK_TREE_CV];
+
+    keccak_sponge_final_pad(&tree->leaf, KECCAK_TREE_PAD_LEAF);
+    keccak_sponge_squeeze(&tree->leaf, cv, sizeof(cv));
+    keccak_sponge_update(&tree->node, cv, sizeof(cv));
+    tree->chunk++;
+    tree->pos = 0;
+}
+
+// TREE
+
+void keccak_tree_init(KeccakTree *tree, const PreparedSchedule *prepared, KeccakPool *pool) {
+    keccak_sponge_init_prepared(&tree->node, prepared);
+    tree->pool = pool;
+    tree->chunk = 0;
+    tree->pos = 0;
+    tree->finalized = 0;
+}
+
+int keccak_tree_update(KeccakTree *tree, const uint8_t *data, size_t len) {
+    if (tree->finalized) {
+        return -1;
+    }
+
+    // S_0 goes straight into the final node
+    if (tree->chunk == 0) {
+        size_t take = KECCAK_TREE_CHUNK - tree->pos;
+        take = len < take ? len : take;
+
+        keccak_sponge_update(&tree->node, data, take);
+        tree->pos += take;
+        data += take;
+        len -= take;
+        if (len == 0) {
+            return 0;
+        }
+        // A second chunk exists: the final node takes the tree form
+        keccak_sponge_update(&tree->node, TREE_MARKER, sizeof(TREE_MARKER));
+        tree->chunk = 1;
+        tree->pos = 0;
+    }
+
+    while (len > 0) {
+        // Whole chunks are hashed in place, in parallel
+        if (tree->pos == 0 && len >= KECCAK_TREE_CHUNK) {
+            uint8_t cvs[TREE_BATCH][KECCAK_TREE_CV];
+            size_t n = len / KECCAK_TREE_CHUNK;
+            n = n < TREE_BATCH ? n : TREE_BATCH;
+
+            if (tree->pool) {
+                keccak_pool_tree_leaves(tree->pool, data, n, &tree->node.prepared, cvs);
+            } else {
+                keccak_tree_leaves(&tree->node.prepared, data, n, cvs);
+            }
+            keccak_sponge_update(&tree->node, cvs[0], n * KECCAK_TREE_CV);
+            tree->chunk += n;
+            data += n * KECCAK_TREE_CHUNK;
+            len -= n * KECCAK_TREE_CHUNK;
+            continue;
+        }
+
+        // A chunk split across calls (or the last, short one)
+        size_t take = KECCAK_TREE_CHUNK - tree->pos;
+        take = len < take ? len : take;
+
+        if (tree->pos == 0) {
+            keccak_sponge_init_prepared(&tree->leaf, &tree->node.prepared);
+        }
+        keccak_sponge_update(&tree->leaf, data, take);
+        tree->pos += take;
+        data += take;
+        len -= take;
+        if (tree->pos == KECCAK_TREE_CHUNK) {
+            finish_leaf(tree);
+        }
+    }
+    return 0;
+}
+
+void keccak_tree_final(KeccakTree *tree) {
+    static const char custom[] = KECCAK_TREE_CUSTOM;
+    static const uint8_t terminator[2] = {0xFF, 0xFF};
+    uint8_t enc[9];
+
+    if (tree->finalized) {
+        return;
+    }
+
+    keccak_tree_update(tree, (const uint8_t*)custom, sizeof(custom) - 1);
+    keccak_tree_update(tree, enc, length_encode(sizeof(custom) - 1, enc));
+    tree->finalized = 1;
+
+    if (tree->chunk == 0) {
+        keccak_sponge_final_pad(&tree->node, KECCAK_TREE_PAD_SINGLE);
+        return;
+    }
+
+    if (tree->pos > 0) {
+        finish_leaf(tree);
+    }
+    // The chunk index now counts S_0 plus the leaves
+    keccak_sponge_update(&tree->node, enc, length_encode(tree->chunk - 1, enc));
+    keccak_sponge_update(&tree->node, terminator, sizeof(terminator));
+    keccak_sponge_final_pad(&tree->node, KECCAK_TREE_PAD_FINAL);
+}
+
+void keccak_tree_squeeze(KeccakTree *tree, uint8_t *out, size_t len) {
+    keccak_tree_final(tree);
+    keccak_sponge_squeeze(&tree->node, out, len);
+}
+
+void keccak_tree_hash(const PreparedSchedule *prepared, const uint8_t *data, size_t len,
+                      uint8_t *out, size_t out_len, KeccakPool *pool) {
+    KeccakTree tree;
+
+    keccak_tree_init(&tree, prepared, pool);
+    keccak_tree_update(&tree, data, len);
+    keccak_tree_squeeze(&tree, out, out_len);
+}
@@ -0,0 +1,84 @@
+#ifndef KECCAK_TREE_H
+#define KECCAK_TREE_H
+
+#include <stddef.h>
+#include "keccak_sponge.h"
+#include "keccak_pool.h"
+
+// Tree hashing in the style of KangarooTwelve, over the polymorphic
+// permutation (rate 136) under one prepared schedule.
+//
+// The input is S = M || KECCAK_TREE_CUSTOM || length_encode(|CUSTOM|),
+// cut into KECCAK_TREE_CHUNK-byte chunks S_0, S_1, ..., S_n.
+//   - n = 0: the digest is the sponge of S with KECCAK_TREE_PAD_SINGLE.
+//   - n > 0: each leaf S_1..S_n is hashed on its own with
+//     KECCAK_TREE_PAD_LEAF into a KECCAK_TREE_CV-byte chaining value, and
+//     the digest is the sponge of the final node
+//         S_0 || 03 00 00 00 00 00 00 00 || CV_1 || ... || CV_n
+//             || length_encode(n) || FF FF
+//     with KECCAK_TREE_PAD_FINAL.
+// length_encode(x) is x in big-endian without leading zero bytes, followed
+// by the number of those bytes (length_encode(0) = 00).
+//
+// Leaves are independent, so they are hashed 16 at a time in lockstep on
+// the SIMD batch kernels and spread across the workers of a KeccakPool.
+// Digests differ from the plain sponge: the domain bits (01 for the plain
+// sponge, 11 single node, 110 leaf, 111 final node) keep the inputs of the
+// different node types apart even under the same schedule.
+
+// Format version, bound into every digest through the customization string.
+// Any change to the layout above gets a new version and a new string.
+#define KECCAK_TREE_VERSION 1
+#define KECCAK_TREE_CUSTOM  "PolyMTD-tree-v1"
+
+#define KECCAK_TREE_CHUNK 8192
+#define KECCAK_TREE_CV    32
+
+// Domain bits followed by the first '1' of pad10*1 (see KECCAK_SPONGE_PAD)
+#define KECCAK_TREE_PAD_SINGLE 0x07
+#define KECCAK_TREE_PAD_LEAF   0x0B
+#define KECCAK_TREE_PAD_FINAL  0x0F
+
+// Incremental tree hash. Whole chunks passed to keccak_tree_update are
+// hashed where they lie; only a chunk split across calls goes through the
+// leaf sponge. Memory use is constant whatever the input length.
+typedef struct {
+    KeccakSponge node;       // final node: S_0, then the chaining values
+    KeccakSponge leaf;       // leaf whose chunk spans update calls
+    KeccakPool *pool;        // leaf workers, NULL for the calling thread only
+    uint64_t chunk;          // index of the chunk being filled (0 = S_0)
+    size_t pos;              // bytes of that chunk absorbed so far
+    int finalized;
+} KeccakTree;
+
+// Start a tree hash. With a pool, batches of whole leaves are hashed by its
+// workers; the pool must not be used by another thread meanwhile.
+void keccak_tree_init(KeccakTree *tree, const PreparedSchedule *prepared, KeccakPool *pool);
+
+// Absorb len bytes; may be called any number of times with any split.
+// Returns 0, or -1 if the tree has already been finalized.
+int keccak_tree_update(KeccakTree *tree, const uint8_t *data, size_t len);
+
+// Append the customization string and close the final node.
+// Calling it again has no effect.
+void keccak_tree_final(KeccakTree *tree);
+
+// Squeeze len bytes of output; may be called repeatedly to extend the output.
+// Finalizes the tree first if keccak_tree_final was not called.
+void keccak_tree_squeeze(KeccakTree *tree, uint8_t *out, size_t len);
+
+// One-shot tree hash of a buffer; pool may be NULL
+void keccak_tree_hash(const PreparedSchedule *prepared, const uint8_t *data, size_t len,
+                      uint8_t *out, size_t out_len, KeccakPool *pool);
+
+// Chaining values of n consecutive whole leaves starting at data, on the
+// calling thread (the per-worker kernel of the parallel path)
+void keccak_tree_leaves(const PreparedSchedule *prepared, const uint8_t *data, size_t n,
+                        uint8_t (*cvs)[KECCAK_TREE_CV]);
+
+// The same leaves split across the workers of pool (keccak_pool_run), each
+// running its share 16 leaves at a time on the SIMD batch kernels
+void keccak_pool_tree_leaves(KeccakPool *pool, const uint8_t *data, size_t n,
+                             const PreparedSchedule *prepared, uint8_t (*cvs)[KECCAK_TREE_CV]);
+
+#endif // KECCAK_TREE_H
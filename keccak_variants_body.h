@@ -0,0 +1,482 @@
+// Variant bodies for one lane type. Included once per lane type by
+// keccak_variants_impl.h (scalar) and keccak_batch.c (SIMD vectors); the
+// includer defines:
+//   KECCAK_LANE      lane type (u64 or a vector of u64)
+//   KECCAK_ROL(x, n) 64-bit rotate of every element of x
+//   KECCAK_FN(name)  name mangling for the instantiated functions
+// Only the operators ^ & | ~ and KECCAK_ROL are used on lanes, so the same
+// source compiles for scalars and GCC/Clang vector types.
+
+// THETA VARIANTS
+
+#ifdef KECCAK_EQUALIZED
+
+// Superset of all theta variants. rot: rotated column parity (V1, V6);
+// kb: rotation of the right neighbour's parity; pair: rotate both
+// neighbours together (V5); row: row-parity term (V2); far: extra
+// rotated parity two columns over (V6).
+KECCAK_INLINE void KECCAK_FN(theta_equalized)(KECCAK_LANE A[25], int rot, int kb,
+                                              int pair, int row, int far) {
+    const u64 m_rot = KECCAK_MASK(rot), n_rot = KECCAK_MASK(!rot);
+    const u64 m_pair = KECCAK_MASK(pair), n_pair = KECCAK_MASK(!pair);
+    const u64 m_row = KECCAK_MASK(row), m_far = KECCAK_MASK(far);
+    KECCAK_LANE C[5], D[5], E[5];
+
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        C[x] = A[x] ^ A[x+15] ^
+               ((A[x+5] ^ A[x+10] ^ A[x+20]) & n_rot) ^
+               ((KECCAK_ROL(A[x+5], 7) ^ KECCAK_ROL(A[x+10], 13) ^ KECCAK_ROL(A[x+20], 19)) & m_rot);
+    }
+
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = (C[l] & n_pair) ^ KECCAK_ROL((C[l] & m_pair) ^ C[r], kb) ^
+               (KECCAK_ROL(C[(x+2)%5], 5) & m_far);
+    }
+
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        int n = (y+1)%5;
+        E[y] = KECCAK_ROL(A[n*5] ^ A[n*5+1] ^ A[n*5+2] ^ A[n*5+3] ^ A[n*5+4], 1) & m_row;
+    }
+
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++)
+        A[i] ^= D[i%5] ^ E[i/5];
+}
+
+// Variant 0: baseline parity
+KECCAK_INLINE void KECCAK_FN(theta_v0)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 0, 1, 0, 0, 0); }
+
+// Variant 1: staggered rotate mix
+KECCAK_INLINE void KECCAK_FN(theta_v1)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 1, 1, 0, 0, 0); }
+
+// Variant 2: row-column diffusion
+KECCAK_INLINE void KECCAK_FN(theta_v2)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 0, 1, 0, 1, 0); }
+
+// Variant 3: double rotate parity
+KECCAK_INLINE void KECCAK_FN(theta_v3)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 0, 2, 0, 0, 0); }
+
+// Variant 4: triple rotate parity
+KECCAK_INLINE void KECCAK_FN(theta_v4)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 0, 3, 0, 0, 0); }
+
+// Variant 5: dual-rot edge
+KECCAK_INLINE void KECCAK_FN(theta_v5)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 0, 1, 1, 0, 0); }
+
+// Variant 6: enhanced triple mix
+KECCAK_INLINE void KECCAK_FN(theta_v6)(KECCAK_LANE A[25]) { KECCAK_FN(theta_equalized)(A, 1, 1, 0, 0, 1); }
+
+#else
+
+// Variant 0: baseline parity
+KECCAK_INLINE void KECCAK_FN(theta_v0)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) 
+        C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = C[l] ^ KECCAK_ROL(C[r], 1);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+// Variant 1: staggered rotate mix
+KECCAK_INLINE void KECCAK_FN(theta_v1)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        C[x] = A[x] ^ 
+               KECCAK_ROL(A[x+5], 7) ^ 
+               KECCAK_ROL(A[x+10], 13) ^ 
+               A[x+15] ^
+               KECCAK_ROL(A[x+20], 19);
+    }
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = C[l] ^ KECCAK_ROL(C[r], 1);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+// Variant 2: row-column diffusion
+KECCAK_INLINE void KECCAK_FN(theta_v2)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], R[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) 
+        C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) 
+        R[y] = A[y*5] ^ A[y*5+1] ^ A[y*5+2] ^ A[y*5+3] ^ A[y*5+4];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        KECCAK_LANE Dx = C[(x+4)%5] ^ KECCAK_ROL(C[(x+1)%5], 1);
+        KECCAK_UNROLL
+        for(int y=0; y<5; y++) {
+            A[x + 5*y] ^= Dx ^ KECCAK_ROL(R[(y+1)%5], 1);
+        }
+    }
+}
+
+// Variant 3: double rotate parity
+KECCAK_INLINE void KECCAK_FN(theta_v3)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) 
+        C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = C[l] ^ KECCAK_ROL(C[r], 2);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+// Variant 4: triple rotate parity
+KECCAK_INLINE void KECCAK_FN(theta_v4)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) 
+        C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = C[l] ^ KECCAK_ROL(C[r], 3);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+// Variant 5: dual-rot edge
+KECCAK_INLINE void KECCAK_FN(theta_v5)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) 
+        C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = KECCAK_ROL(C[l], 1) ^ KECCAK_ROL(C[r], 1);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+// Variant 6: enhanced triple mix
+KECCAK_INLINE void KECCAK_FN(theta_v6)(KECCAK_LANE A[25]) {
+    KECCAK_LANE C[5], D[5];
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        C[x] = A[x] ^ 
+               KECCAK_ROL(A[x+5], 7) ^ 
+               KECCAK_ROL(A[x+10], 13) ^ 
+               A[x+15] ^
+               KECCAK_ROL(A[x+20], 19);
+    }
+    
+    KECCAK_UNROLL
+    for(int x=0; x<5; x++) {
+        int l = (x+4)%5, r = (x+1)%5;
+        D[x] = C[l] ^ KECCAK_ROL(C[r], 1) ^ KECCAK_ROL(C[(x+2)%5], 5);
+    }
+    
+    KECCAK_UNROLL
+    for(int i=0; i<25; i++) 
+        A[i] ^= D[i%5];
+}
+
+#endif // KECCAK_EQUALIZED
+
+// RHO-PI VARIANTS
+
+// Each variant has an in-place form (rhopi_vN) and a form that writes
+// into a second buffer (rhopi_vN_to) for the fused rho-pi + chi path.
+
+// Variant 0: standard mapping
+KECCAK_INLINE void KECCAK_FN(rhopi_v0)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 0); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v0_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 0); }
+
+// Variant 1: fibonacci offsets
+KECCAK_INLINE void KECCAK_FN(rhopi_v1)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 1); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v1_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 1); }
+
+// Variant 2: prime offsets
+KECCAK_INLINE void KECCAK_FN(rhopi_v2)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 2); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v2_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 2); }
+
+// Variant 3: uniform offsets
+KECCAK_INLINE void KECCAK_FN(rhopi_v3)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 3); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v3_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 3); }
+
+// Variant 4: transpose mapping
+KECCAK_INLINE void KECCAK_FN(rhopi_v4)(KECCAK_LANE A[25]) {
+    KECCAK_LANE t, u;
+
+    t = A[1];
+    TRANSPOSE_CYCLE_1(LANE_MOVE, A, RHOPI_ROT[4])
+    t = A[7];
+    TRANSPOSE_CYCLE_7(LANE_MOVE, A, RHOPI_ROT[4])
+}
+
+KECCAK_INLINE void KECCAK_FN(rhopi_v4_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) {
+    B[0] = A[0];
+    TRANSPOSE_CYCLE_1(LANE_SCATTER, B, A, RHOPI_ROT[4])
+    TRANSPOSE_CYCLE_7(LANE_SCATTER, B, A, RHOPI_ROT[4])
+}
+
+// Variant 5: position-based mix
+KECCAK_INLINE void KECCAK_FN(rhopi_v5)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 5); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v5_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 5); }
+
+// Variant 6: row-major offsets
+KECCAK_INLINE void KECCAK_FN(rhopi_v6)(KECCAK_LANE A[25]) { RHOPI_PI_INPLACE(A, 6); }
+KECCAK_INLINE void KECCAK_FN(rhopi_v6_to)(KECCAK_LANE B[25], const KECCAK_LANE A[25]) { RHOPI_PI_SCATTER(B, A, 6); }
+
+// CHI VARIANTS
+
+// Chi bodies compute A = chi(B) row by row. Each row of B is read into temp
+// before the row of A is written, so B may alias A for the in-place step.
+
+#ifdef KECCAK_EQUALIZED
+
+// Superset of all chi variants. Every variant can be written as
+// A = a ^ P ^ (b & Q) over the row neighbours b, c, d at offsets ob, oc, od:
+//   P = (c & w) ^ R,              R = rol(d, kr) if r_on
+//   Q = (c op u) ^ ((rol(c, 1) ^ R) if q_rot)
+// with w, u each one of d / all-ones / zero and op one of & | ^:
+//   V0-V3  ~b & c                               P = c, Q = c
+//   V4     (b & rol(c, 1)) | (~b & rol(d, 3))   P = rol(d, 3), Q = rol(c, 1) ^ rol(d, 3)
+//   V5     (~b & c) | (b & ~c & d)              P = c, Q = c | d
+//   V6     maj(b, c, d) ^ rol(d, 7)             P = (c & d) ^ rol(d, 7), Q = c ^ d
+// w and u are built as (d & mask) | ones, and op is selected by masking
+// c & u and c ^ u (c | u being their XOR), so every variant evaluates the
+// same terms and only the row offsets and rotation amounts differ.
+KECCAK_INLINE void KECCAK_FN(chi_equalized)(KECCAK_LANE A[25], const KECCAK_LANE B[25],
+                                            int ob, int oc, int od, int w, int kr, int r_on,
+                                            int op, int u, int q_rot) {
+    const u64 m_r = KECCAK_MASK(r_on), m_q = KECCAK_MASK(q_rot);
+    const u64 m_wd = KECCAK_MASK(w == CHI_D), k_w = KECCAK_MASK(w == CHI_ONES);
+    const u64 m_ud = KECCAK_MASK(u == CHI_D), k_u = KECCAK_MASK(u == CHI_ONES);
+    const u64 m_and = KECCAK_MASK(op != CHI_XOR), m_xor = KECCAK_MASK(op != CHI_AND);
+    KECCAK_LANE temp[5];
+
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++)
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            KECCAK_LANE b = temp[(x+ob)%5];
+            KECCAK_LANE c = temp[(x+oc)%5];
+            KECCAK_LANE d = temp[(x+od)%5];
+            KECCAK_LANE wv = (d & m_wd) | k_w;
+            KECCAK_LANE uv = (d & m_ud) | k_u;
+            KECCAK_LANE R = KECCAK_ROL(d, kr) & m_r;
+            KECCAK_LANE P = (c & wv) ^ R;
+            KECCAK_LANE Q = ((c & uv) & m_and) ^ ((c ^ uv) & m_xor) ^
+                            ((KECCAK_ROL(c, 1) ^ R) & m_q);
+            A[x + 5*y] = temp[x] ^ P ^ (b & Q);
+        }
+    }
+}
+
+// Variant 0: canonical boolean mix
+KECCAK_INLINE void KECCAK_FN(chi_v0)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 1, 2, 3, CHI_ONES, 3, 0, CHI_AND, CHI_ONES, 0);
+}
+
+// Variant 1: shifted neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v1)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 2, 3, 4, CHI_ONES, 3, 0, CHI_AND, CHI_ONES, 0);
+}
+
+// Variant 2: extended neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v2)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 3, 4, 1, CHI_ONES, 3, 0, CHI_AND, CHI_ONES, 0);
+}
+
+// Variant 3: reverse neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v3)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 4, 3, 2, CHI_ONES, 3, 0, CHI_AND, CHI_ONES, 0);
+}
+
+// Variant 4: conditional rotate blend
+KECCAK_INLINE void KECCAK_FN(chi_v4)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 1, 2, 3, CHI_ZERO, 3, 1, CHI_AND, CHI_ZERO, 1);
+}
+
+// Variant 5: high nonlinearity
+KECCAK_INLINE void KECCAK_FN(chi_v5)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 1, 2, 3, CHI_ONES, 3, 0, CHI_OR, CHI_D, 0);
+}
+
+// Variant 6: balanced majority rotate
+KECCAK_INLINE void KECCAK_FN(chi_v6)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_FN(chi_equalized)(A, B, 1, 2, 3, CHI_D, 7, 1, CHI_XOR, CHI_D, 0);
+}
+
+#else
+
+// Variant 0: canonical boolean mix
+KECCAK_INLINE void KECCAK_FN(chi_v0)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            A[x + 5*y] = temp[x] ^ (~temp[(x+1)%5] & temp[(x+2)%5]);
+        }
+    }
+}
+
+// Variant 1: shifted neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v1)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            A[x + 5*y] = temp[x] ^ (~temp[(x+2)%5] & temp[(x+3)%5]);
+        }
+    }
+}
+
+// Variant 2: extended neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v2)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            A[x + 5*y] = temp[x] ^ (~temp[(x+3)%5] & temp[(x+4)%5]);
+        }
+    }
+}
+
+// Variant 3: reverse neighbor mask
+KECCAK_INLINE void KECCAK_FN(chi_v3)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            A[x + 5*y] = temp[x] ^ (~temp[(x+4)%5] & temp[(x+3)%5]);
+        }
+    }
+}
+
+// Variant 4: conditional rotate blend
+KECCAK_INLINE void KECCAK_FN(chi_v4)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            KECCAK_LANE b = temp[(x+1)%5];
+            KECCAK_LANE c = temp[(x+2)%5];
+            KECCAK_LANE d = temp[(x+3)%5];
+            KECCAK_LANE rotated_c = KECCAK_ROL(c, 1);
+            KECCAK_LANE rotated_d = KECCAK_ROL(d, 3);
+            A[x + 5*y] = temp[x] ^ ((b & rotated_c) | (~b & rotated_d));
+        }
+    }
+}
+
+// Variant 5: high nonlinearity
+KECCAK_INLINE void KECCAK_FN(chi_v5)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            KECCAK_LANE a = temp[x];
+            KECCAK_LANE b = temp[(x+1)%5];
+            KECCAK_LANE c = temp[(x+2)%5];
+            KECCAK_LANE d = temp[(x+3)%5];
+            A[x + 5*y] = a ^ ((~b & c) | (b & ~c & d));
+        }
+    }
+}
+
+// Variant 6: balanced majority rotate
+KECCAK_INLINE void KECCAK_FN(chi_v6)(KECCAK_LANE A[25], const KECCAK_LANE B[25]) {
+    KECCAK_LANE temp[5];
+    
+    KECCAK_UNROLL
+    for(int y=0; y<5; y++) {
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) 
+            temp[x] = B[x + 5*y];
+        KECCAK_UNROLL
+        for(int x=0; x<5; x++) {
+            KECCAK_LANE a = temp[x];
+            KECCAK_LANE b = temp[(x+1)%5];
+            KECCAK_LANE c = temp[(x+2)%5];
+            KECCAK_LANE d = temp[(x+3)%5];
+            KECCAK_LANE maj = (b & c) | (b & d) | (c & d);
+            A[x + 5*y] = a ^ maj ^ KECCAK_ROL(d, 7);
+        }
+    }
+}
+
+#endif // KECCAK_EQUALIZED
+
+#undef KECCAK_LANE
+#undef KECCAK_ROL
+#undef KECCAK_FN
@@ -0,0 +1,270 @@
+// Inline bodies of the theta, rho-pi and chi variants.
+// Shared by the exported step functions in Keccak_All_Updated_Variants.c
+// and by the fused round kernels in keccak_engine.c, which inline several
+// steps into one function so the state stays in registers across a round.
+// The bodies themselves live in keccak_variants_body.h so they can also be
+// instantiated for SIMD lane types.
+
+#ifndef KECCAK_VARIANTS_IMPL_H
+#define KECCAK_VARIANTS_IMPL_H
+
+#include "keccak_variants.h"
+
+// Force inlining so fused kernels are not left calling the step bodies
+#if defined(_MSC_VER)
+#define KECCAK_INLINE static __forceinline
+#elif defined(__GNUC__)
+#define KECCAK_INLINE static inline __attribute__((always_inline))
+#else
+#define KECCAK_INLINE static inline
+#endif
+
+// Fully unroll the fixed-trip 5/25-lane loops so every index is a constant
+// and the state can be scalarised into registers
+#if defined(__clang__)
+#define KECCAK_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define KECCAK_UNROLL _Pragma("GCC unroll 25")
+#else
+#define KECCAK_UNROLL
+#endif
+
+static inline u64 rol64(u64 x, int n) {
+    return (x << n) | (x >> ((64 - n) & 63));
+}
+
+// RHO-PI VARIANTS
+
+// Lane moves of each rho-pi permutation as X(src, dst, ...) entries, listed
+// along the permutation cycles so they can be applied in place. Lane 0 is a
+// fixed point with rotation 0 in every variant and is never moved.
+
+// Standard pi (x, y) -> (y, 2x + 3y): lanes 1..24 form a single cycle.
+// Used by variants 0, 1, 2, 3, 5 and 6.
+#define PI_CYCLE(X, ...) \
+    X( 1, 10, __VA_ARGS__) X(10,  7, __VA_ARGS__) X( 7, 11, __VA_ARGS__) \
+    X(11, 17, __VA_ARGS__) X(17, 18, __VA_ARGS__) X(18,  3, __VA_ARGS__) \
+    X( 3,  5, __VA_ARGS__) X( 5, 16, __VA_ARGS__) X(16,  8, __VA_ARGS__) \
+    X( 8, 21, __VA_ARGS__) X(21, 24, __VA_ARGS__) X(24,  4, __VA_ARGS__) \
+    X( 4, 15, __VA_ARGS__) X(15, 23, __VA_ARGS__) X(23, 19, __VA_ARGS__) \
+    X(19, 13, __VA_ARGS__) X(13, 12, __VA_ARGS__) X(12,  2, __VA_ARGS__) \
+    X( 2, 20, __VA_ARGS__) X(20, 14, __VA_ARGS__) X(14, 22, __VA_ARGS__) \
+    X(22,  9, __VA_ARGS__) X( 9,  6, __VA_ARGS__) X( 6,  1, __VA_ARGS__)
+
+// Transpose mapping (x, y) -> (y, x + y) of variant 4: a 20-cycle through
+// lane 1 and a 4-cycle through lane 7.
+#define TRANSPOSE_CYCLE_1(X, ...) \
+    X( 1,  5, __VA_ARGS__) X( 5,  6, __VA_ARGS__) X( 6, 11, __VA_ARGS__) \
+    X(11, 17, __VA_ARGS__) X(17,  3, __VA_ARGS__) X( 3, 15, __VA_ARGS__) \
+    X(15, 18, __VA_ARGS__) X(18,  8, __VA_ARGS__) X( 8, 21, __VA_ARGS__) \
+    X(21,  4, __VA_ARGS__) X( 4, 20, __VA_ARGS__) X(20, 24, __VA_ARGS__) \
+    X(24, 19, __VA_ARGS__) X(19, 13, __VA_ARGS__) X(13,  2, __VA_ARGS__) \
+    X( 2, 10, __VA_ARGS__) X(10, 12, __VA_ARGS__) X(12, 22, __VA_ARGS__) \
+    X(22,  9, __VA_ARGS__) X( 9,  1, __VA_ARGS__)
+#define TRANSPOSE_CYCLE_7(X, ...) \
+    X( 7, 16, __VA_ARGS__) X(16, 23, __VA_ARGS__) X(23, 14, __VA_ARGS__) \
+    X(14,  7, __VA_ARGS__)
+
+// Compile-time checks of the cycle tables:
+//   - bijectivity: the moves of a mapping use every non-zero lane exactly
+//     once as a source and once as a destination;
+//   - formula: every move sends src = x + 5y to the lane its mapping gives;
+//   - chain: each move's destination is the next move's source and the last
+//     one returns to the first, which the in-place LANE_MOVE relies on. A
+//     cycle starting at lane s expands to s == src0 && dst0 == src1 && ...
+//     && dst(n-1) == s.
+#define KECCAK_STATIC_ASSERT(cond, name) typedef char name[(cond) ? 1 : -1]
+#define LANE_SRC_BIT(src, dst, unused) | (1UL << (src))
+#define LANE_DST_BIT(src, dst, unused) | (1UL << (dst))
+#define LANE_COUNT(src, dst, unused) + 1
+#define LANE_CHAIN(src, dst, unused) == (src) && (dst)
+#define LANE_IS_PI(src, dst, unused) \
+    && (dst) == (src) / 5 + 5 * ((2 * ((src) % 5) + 3 * ((src) / 5)) % 5)
+#define LANE_IS_TRANSPOSE(src, dst, unused) \
+    && (dst) == (src) / 5 + 5 * (((src) % 5 + (src) / 5) % 5)
+#define NONZERO_LANES 0x1FFFFFEUL
+
+KECCAK_STATIC_ASSERT((0 PI_CYCLE(LANE_SRC_BIT, 0)) == NONZERO_LANES &&
+                     (0 PI_CYCLE(LANE_DST_BIT, 0)) == NONZERO_LANES &&
+                     (0 PI_CYCLE(LANE_COUNT, 0)) == 24,
+                     pi_cycle_is_bijective);
+KECCAK_STATIC_ASSERT((0 TRANSPOSE_CYCLE_1(LANE_SRC_BIT, 0) TRANSPOSE_CYCLE_7(LANE_SRC_BIT, 0)) == NONZERO_LANES &&
+                     (0 TRANSPOSE_CYCLE_1(LANE_DST_BIT, 0) TRANSPOSE_CYCLE_7(LANE_DST_BIT, 0)) == NONZERO_LANES &&
+                     (0 TRANSPOSE_CYCLE_1(LANE_COUNT, 0) TRANSPOSE_CYCLE_7(LANE_COUNT, 0)) == 24,
+                     transpose_cycles_are_bijective);
+KECCAK_STATIC_ASSERT((1 PI_CYCLE(LANE_IS_PI, 0)) && (1 PI_CYCLE(LANE_CHAIN, 0) == 1),
+                     pi_cycle_follows_the_mapping);
+KECCAK_STATIC_ASSERT((1 TRANSPOSE_CYCLE_1(LANE_IS_TRANSPOSE, 0) TRANSPOSE_CYCLE_7(LANE_IS_TRANSPOSE, 0)) &&
+                     (1 TRANSPOSE_CYCLE_1(LANE_CHAIN, 0) == 1) &&
+                     (7 TRANSPOSE_CYCLE_7(LANE_CHAIN, 0) == 7),
+                     transpose_cycles_follow_the_mapping);
+
+// Rotation applied to each source lane, indexed by lane x + 5*y.
+// Constant-indexed reads fold to immediates once the moves are expanded.
+static const int RHOPI_ROT[7][25] = {
+    // Variant 0: standard mapping
+    {  0,  1, 62, 28, 27, 36, 44,  6, 55, 20,  3, 10, 43, 25, 39, 41, 45, 15, 21,  8, 18,  2, 61, 56, 14 },
+    // Variant 1: fibonacci offsets
+    {  0,  5, 55, 34, 45,  1,  8, 25, 27, 18,  1, 13, 16, 61, 63,  2, 21, 41, 24,  7,  3, 34, 57, 21, 14 },
+    // Variant 2: prime offsets
+    {  0, 11, 29, 47,  7,  2, 13, 31, 53, 11,  3, 17, 37, 59, 13,  5, 19, 41, 61, 17,  7, 23, 43,  1, 19 },
+    // Variant 3: uniform offsets
+    {  0, 13, 26, 38, 51,  3, 15, 28, 41, 54,  5, 18, 31, 44, 56,  8, 21, 33, 46, 59, 10, 23, 36, 49, 62 },
+    // Variant 4: transpose mapping
+    {  0,  1, 62, 28, 27, 36, 44,  6, 55, 20,  3, 10, 43, 25, 39, 41, 45, 15, 21,  8, 18,  2, 61, 56, 14 },
+    // Variant 5: position-based mix, ((x*7 + y*11) + (x'*13 + y'*17)) % 64
+    {  0, 41, 18, 38, 15, 11, 31,  8, 49,  5,  1, 42, 62, 39, 16, 12, 32,  9, 29,  6,  2, 43, 63, 40, 60 },
+    // Variant 6: row-major offsets
+    {  0,  8, 25, 35, 15,  1, 13, 16, 39, 22,  2, 21,  9, 44, 30,  3, 34,  4, 50, 39,  5, 55,  2, 57, 49 }
+};
+
+// In-place move along a cycle; t carries the lane displaced by the previous move
+#define LANE_MOVE(src, dst, A, rot) \
+    u = A[dst]; A[dst] = KECCAK_ROL(t, rot[src]); t = u;
+
+// Out-of-place move into a second buffer
+#define LANE_SCATTER(src, dst, B, A, rot) \
+    B[dst] = KECCAK_ROL(A[src], rot[src]);
+
+#define RHOPI_PI_INPLACE(A, v)                                  \
+    do {                                                        \
+        KECCAK_LANE t = A[1], u;                                \
+        PI_CYCLE(LANE_MOVE, A, RHOPI_ROT[v])                    \
+    } while (0)
+
+#define RHOPI_PI_SCATTER(B, A, v)                               \
+    do {                                                        \
+        B[0] = A[0];                                            \
+        PI_CYCLE(LANE_SCATTER, B, A, RHOPI_ROT[v])              \
+    } while (0)
+
+// LATENCY-EQUALIZED BUILD
+
+// With -DKECCAK_EQUALIZED every theta variant and every chi variant runs
+// one superset body per step whose terms are switched on or off by
+// all-ones / all-zero masks, so the variants of a step differ only in
+// immediates (rotation amounts and lane offsets). The masks pass through
+// keccak_opaque() so the compiler can neither drop the disabled terms nor
+// merge equal masks, which would free registers in some variants only.
+// Register allocation still differs between the round kernels, so the
+// variants match in operations, not exactly in cycles (see bench_variants).
+// Rho-pi variants already share one shape (24 rotate-and-move steps) and
+// iota is a table lookup in every variant, so neither needs a special form.
+#ifdef KECCAK_EQUALIZED
+#if defined(__GNUC__)
+static inline u64 keccak_opaque(u64 x) {
+    __asm__ volatile("" : "+r"(x));
+    return x;
+}
+#else
+static inline u64 keccak_opaque(u64 x) {
+    volatile u64 v = x;
+    return v;
+}
+#endif
+
+#define KECCAK_MASK(on) keccak_opaque((on) ? ~0ULL : 0ULL)
+
+// Operand and operator selectors of the equalized chi body
+#define CHI_ONES 0
+#define CHI_ZERO 1
+#define CHI_D    2
+#define CHI_AND  0
+#define CHI_OR   1
+#define CHI_XOR  2
+#endif
+
+// IOTA VARIANTS
+
+// Round constants of every iota variant, indexed [variant][round]. Each
+// iota variant XORs its constant into A[0], so constant-indexed reads fold
+// to immediates in fully specialized rounds (see keccak_static.h).
+static const u64 IOTA_RC[7][24] = {
+    // Variant 0: standard RC set
+    {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+        0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+        0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+        0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+        0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+        0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+        0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+    },
+    // Variant 1: phi based constants
+    {
+        0x06BC5545CFC8F594ULL, 0xA4F3CEFF4F1371A9ULL, 0x432B48B8CE5DEDBEULL,
+        0xE162C2724DA869D3ULL, 0x7F9A3C2BCCF2E5E8ULL, 0x1DD1B5E54C3D61FDULL,
+        0xBC092F9ECB87DE12ULL, 0x5A40A9584AD25A27ULL, 0xF8782311CA1CD63CULL,
+        0x96AF9CCB49675251ULL, 0x34E71684C8B1CE66ULL, 0xD31E903E47FC4A7BULL,
+        0x715609F7C746C690ULL, 0x0F8D83B1469142A5ULL, 0xADC4FD6AC5DBBEBAULL,
+        0x4BFC772445263ACFULL, 0xEA33F0DDC470B6E4ULL, 0x886B6A9743BB32F9ULL,
+        0x26A2E450C305AF0EULL, 0xC4DA5E0A42502B23ULL, 0x6311D7C3C19AA738ULL,
+        0x0149517D40E5234DULL, 0x9F80CB36C02F9F62ULL, 0x3DB844F03F7A1B77ULL
+    },
+    // Variant 2: CA derived constants
+    {
+        0xdcc593ae756195abULL, 0xf0f15c12c71b6808ULL, 0xfba71d7064679f81ULL,
+        0xfd96e0b1b18ed95fULL, 0xdadbdcbb100372cbULL, 0xc987c0b67909f069ULL,
+        0x64bac1a452ebec40ULL, 0xf51e968d1e10f1e8ULL, 0x4a2ac120270d9df9ULL,
+        0x03b893064e487d12ULL, 0x0374c9c06fa50f63ULL, 0xa1611e8a0b618d79ULL,
+        0x5ea41c38037e4e84ULL, 0xe1409e0cb3ee025fULL, 0x9048ad54bc95df4fULL,
+        0xcc8940da3d0fc244ULL, 0x80383a87fc613d0fULL, 0x77438338845faf78ULL,
+        0xb94c598b703659ecULL, 0xca6f5bbcf1da3800ULL, 0x5c9dec36444e0aa3ULL,
+        0x1010402d5f031aa6ULL, 0x2dd1a27321830397ULL, 0x58fefd9faa23983bULL
+    },
+    // Variant 3: sha256 style constants
+    {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+        0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+        0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+        0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+        0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+        0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+        0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL
+    },
+    // Variant 4: pi derived constants
+    {
+        0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL, 0xa4093822299f31d0ULL,
+        0x082efa98ec4e6c89ULL, 0x452821e638d01377ULL, 0xbe5466cf34e90c6cULL,
+        0xc0ac29b7c97c50ddULL, 0x3f84d5b5b5470917ULL, 0x9216d5d98979fb1bULL,
+        0xd1310ba698dfb5acULL, 0x2ffd72dbd01adfb7ULL, 0xb8e1afed6a267e96ULL,
+        0xba7c9045f12c7f99ULL, 0x24a19947b3916cf7ULL, 0x0801f2e2858efc16ULL,
+        0x636920d871574e69ULL, 0xa458fea3f4933d7eULL, 0x0d95748f728eb658ULL,
+        0x718bcd5882154aeeULL, 0x7b54a41dc25a59b5ULL, 0x9c30d5392af26013ULL,
+        0xc5d1b023286085f0ULL, 0xca417918b8db38efULL, 0x8e79dcb0603a180eULL
+    },
+    // Variant 5: e derived constants
+    {
+        0x2b7e151628aed2a6ULL, 0xabf7158809cf4f3cULL, 0x762e7160f38b4da5ULL,
+        0x6a784d9045190cfeULL, 0xf324e7738926cfbeULL, 0x5f4bf8d8d8c31d76ULL,
+        0x3da06c80abb1185eULL, 0xb4f7c7b5757f5958ULL, 0x490cfd47d7c19bb4ULL,
+        0x2158d9554f7b46bcULL, 0xed55c4d79fd5f24dULL, 0x6613c31c3839a2ddULL,
+        0xf8a9a276bcfbfa1cULL, 0x877c56284dab79cdULL, 0x4c2b3293d20e9e5eULL,
+        0xa0248876229c6c1dULL, 0xd41244d6da212011ULL, 0x19a4c58dc8544d65ULL,
+        0xd19d99d435061763ULL, 0x3e1f0e42d76632c0ULL, 0x24aa23a41031e7e4ULL,
+        0xe08f11559139d499ULL, 0x1c8340a5a3068e4cULL, 0x5466861d07c09362ULL
+    },
+    // Variant 6: lfsr driven constants. State r is the seed
+    // 0x243f6a8885a308d3 shifted left r + 1 times, XORing in 0x1B whenever
+    // the top bit falls out, unrolled here instead of stepped per call.
+    {
+        0x487ed5110b4611a6ULL, 0x90fdaa22168c234cULL, 0x21fb54442d184683ULL,
+        0x43f6a8885a308d06ULL, 0x87ed5110b4611a0cULL, 0x0fdaa22168c23403ULL,
+        0x1fb54442d1846806ULL, 0x3f6a8885a308d00cULL, 0x7ed5110b4611a018ULL,
+        0xfdaa22168c234030ULL, 0xfb54442d1846807bULL, 0xf6a8885a308d00edULL,
+        0xed5110b4611a01c1ULL, 0xdaa22168c2340399ULL, 0xb54442d184680729ULL,
+        0x6a8885a308d00e49ULL, 0xd5110b4611a01c92ULL, 0xaa22168c2340393fULL,
+        0x54442d1846807265ULL, 0xa8885a308d00e4caULL, 0x5110b4611a01c98fULL,
+        0xa22168c23403931eULL, 0x4442d18468072627ULL, 0x8885a308d00e4c4eULL
+    }
+};
+
+// Scalar instantiation: theta_vN_impl, rhopi_vN_impl, rhopi_vN_to_impl, chi_vN_impl
+#define KECCAK_LANE u64
+#define KECCAK_ROL rol64
+#define KECCAK_FN(name) name##_impl
+#include "keccak_variants_body.h"
+
+#endif // KECCAK_VARIANTS_IMPL_H
@@ -0,0 +1,137 @@
+#include <string.h>
+
+#include "keccak_xof.h"
+#include "keccak_batch.h"
+
+// Counter blocks permuted in lockstep per SIMD batch call (a multiple of
+// every vector width, and the chunk a pool worker takes at a time)
+#define XOF_GROUP 16
+
+// SEQUENTIAL XOF
+
+void keccak_xof_init(KeccakXof *xof, const PreparedSchedule *prepared) {
+    keccak_sponge_init_prepared(&xof->sponge, prepared);
+}
+
+int keccak_xof_update(KeccakXof *xof, const uint8_t *data, size_t len) {
+    return keccak_sponge_update(&xof->sponge, data, len);
+}
+
+void keccak_xof_squeeze(KeccakXof *xof, uint8_t *out, size_t len) {
+    keccak_sponge_final_pad(&xof->sponge, KECCAK_XOF_PAD);
+    keccak_sponge_squeeze(&xof->sponge, out, len);
+}
+
+void keccak_xof(const PreparedSchedule *prepared, const uint8_t *data, size_t len,
+                uint8_t *out, size_t out_len) {
+    KeccakXof xof;
+
+    keccak_xof_init(&xof, prepared);
+    keccak_xof_update(&xof, data, len);
+    keccak_xof_squeeze(&xof, out, out_len);
+}
+
+// COUNTER MODE
+
+int keccak_xof_counter_init(KeccakXofCounter *ctr, KeccakXof *xof) {
+    if (xof->sponge.squeezing) {
+        return -1;
+    }
+    keccak_sponge_final_pad(&xof->sponge, KECCAK_XOF_PAD_COUNTER);
+    memcpy(ctr->state, xof->sponge.state, sizeof(ctr->state));
+    ctr->prepared = xof->sponge.prepared;
+    return 0;
+}
+
+// count <= XOF_GROUP consecutive blocks as one structure-of-arrays batch
+static void counter_group(const KeccakXofCounter *ctr, uint64_t first, size_t count,
+                          uint8_t *out) {
+    u64 lanes[25 * XOF_GROUP];
+
+    for (int i = 0; i < 25; i++) {
+        for (size_t j = 0; j < count; j++) {
+            lanes[i * count + j] = ctr->state[i];
+        }
+    }
+    for (size_t j = 0; j < count; j++) {
+        lanes[j] ^= first + j;
+    }
+    keccak_f_poly_batch(lanes, count, &ctr->prepared);
+
+    for (size_t j = 0; j < count; j++) {
+        for (int i = 0; i < KECCAK_SPONGE_LANES; i++) {
+            store64_le(out + j * KECCAK_XOF_BLOCK + 8 * i, lanes[i * count + j]);
+        }
+    }
+}
+
+void keccak_xof_counter_blocks(const KeccakXofCounter *ctr, uint64_t first, size_t n,
+                               uint8_t *out) {
+    for (size_t j = 0; j < n; j += XOF_GROUP) {
+        size_t count = n - j < XOF_GROUP ? n - j : XOF_GROUP;
+        counter_group(ctr, first + j, count, out + j * KECCAK_XOF_BLOCK);
+    }
+}
+
+// Counter-mode blocks published to the pool workers
+typedef struct {
+    const KeccakXofCounter *ctr;
+    uint64_t first;
+    uint8_t *out;
+} XofBlocksJob;
+
+static void blocks_range(void *ctx, size_t begin, size_t end) {
+    const XofBlocksJob *job = (const XofBlocksJob*)ctx;
+    keccak_xof_counter_blocks(job->ctr, job->first + begin, end - begin,
+                              job->out + begin * KECCAK_XOF_BLOCK);
+}
+
+void keccak_pool_xof_blocks(KeccakPool *pool, const KeccakXofCounter *ctr, uint64_t first,
+                            size_t n, uint8_t *out) {
+    XofBlocksJob job = {ctr, first, out};
+    keccak_pool_run(pool, n, blocks_range, &job);
+}
+
+// Bytes [skip, skip + len) of one block, len <= KECCAK_XOF_BLOCK - skip
+static void counter_partial(const KeccakXofCounter *ctr, uint64_t block, size_t skip,
+                            uint8_t *out, size_t len) {
+    uint8_t buf[KECCAK_XOF_BLOCK];
+
+    keccak_xof_counter_blocks(ctr, block, 1, buf);
+    memcpy(out, buf + skip, len);
+}
+
+void keccak_xof_counter_read(const KeccakXofCounter *ctr, uint64_t offset, uint8_t *out,
+                             size_t len, KeccakPool *pool) {
+    uint64_t block = offset / KECCAK_XOF_BLOCK;
+    size_t skip = (size_t)(offset % KECCAK_XOF_BLOCK);
+
+    // Head: the rest of a block entered mid-way
+    if (skip != 0 && len > 0) {
+        size_t take = KECCAK_XOF_BLOCK - skip;
+        take = len < take ? len : take;
+
+        counter_partial(ctr, block, skip, out, take);
+        block++;
+        out += take;
+        len -= take;
+    }
+
+    // Whole blocks go straight into the caller's buffer
+    size_t n = len / KECCAK_XOF_BLOCK;
+    if (n > 0) {
+        if (pool) {
+            keccak_pool_xof_blocks(pool, ctr, block, n, out);
+        } else {
+            keccak_xof_counter_blocks(ctr, block, n, out);
+        }
+        block += n;
+        out += n * KECCAK_XOF_BLOCK;
+        len -= n * KECCAK_XOF_BLOCK;
+    }
+
+    // Tail: the start of one more block
+    if (len > 0) {
+        counter_partial(ctr, block, 0, out, len);
+    }
+}
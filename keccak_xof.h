@@ -0,0 +1,77 @@
+#ifndef KECCAK_XOF_H
+#define KECCAK_XOF_H
+
+#include <stddef.h>
+#include "keccak_sponge.h"
+#include "keccak_pool.h"
+
+// Extendable-output function over the polymorphic permutation, in the style
+// of SHAKE: the sponge of keccak_sponge.h (rate 136) closed with its own
+// domain bits, so that an XOF output never shares a prefix with a digest of
+// the same message. Output is squeezed 136 bytes per permutation, as long
+// as the caller likes.
+//
+// Counter mode is a second, seekable output stream for the same input. The
+// input is absorbed as above but closed with KECCAK_XOF_PAD_COUNTER, giving
+// a secret state S. Output block i (136 bytes) is the rate part of
+//     f(S ^ i)     (i as a 64-bit little-endian word XORed into lane 0)
+// Blocks are independent of one another, so any byte range can be produced
+// directly, 16 blocks at a time on the SIMD batch kernels and across the
+// workers of a KeccakPool. S itself is never output: every block goes
+// through a permutation first.
+
+// Domain bits followed by the first '1' of pad10*1 (see KECCAK_SPONGE_PAD):
+// SHAKE's 1111 for the sequential XOF, 11110 for counter mode
+#define KECCAK_XOF_PAD         0x1F
+#define KECCAK_XOF_PAD_COUNTER 0x2F
+
+// Bytes per output block, one permutation each
+#define KECCAK_XOF_BLOCK KECCAK_SPONGE_RATE
+
+// Sequential XOF
+typedef struct {
+    KeccakSponge sponge;
+} KeccakXof;
+
+// Seekable counter-mode generator: the closed state S and its schedule.
+// Read-only once set up, so any number of threads may read from it.
+typedef struct KeccakXofCounter {
+    u64 state[25];
+    PreparedSchedule prepared;
+} KeccakXofCounter;
+
+// Start an XOF under a prepared schedule (copied into xof)
+void keccak_xof_init(KeccakXof *xof, const PreparedSchedule *prepared);
+
+// Absorb len bytes; may be called any number of times with any split.
+// Returns 0, or -1 once output has been squeezed.
+int keccak_xof_update(KeccakXof *xof, const uint8_t *data, size_t len);
+
+// Squeeze len bytes; may be called repeatedly to extend the output. The
+// first call closes the input.
+void keccak_xof_squeeze(KeccakXof *xof, uint8_t *out, size_t len);
+
+// One-shot XOF of a buffer
+void keccak_xof(const PreparedSchedule *prepared, const uint8_t *data, size_t len,
+                uint8_t *out, size_t out_len);
+
+// Close the input of xof in counter mode instead and set up ctr.
+// Returns 0, or -1 if xof has already been squeezed. xof is spent either way.
+int keccak_xof_counter_init(KeccakXofCounter *ctr, KeccakXof *xof);
+
+// Output blocks first .. first + n - 1, written to out (n * KECCAK_XOF_BLOCK
+// bytes), on the calling thread (the per-worker kernel of the parallel path)
+void keccak_xof_counter_blocks(const KeccakXofCounter *ctr, uint64_t first, size_t n,
+                               uint8_t *out);
+
+// The same blocks split across the workers of pool (keccak_pool_run), each
+// running its share 16 blocks at a time on the SIMD batch kernels
+void keccak_pool_xof_blocks(KeccakPool *pool, const KeccakXofCounter *ctr, uint64_t first,
+                            size_t n, uint8_t *out);
+
+// Bytes offset .. offset + len - 1 of the counter-mode stream. With a pool,
+// the whole blocks are spread across its workers; pool may be NULL.
+void keccak_xof_counter_read(const KeccakXofCounter *ctr, uint64_t offset, uint8_t *out,
+                             size_t len, KeccakPool *pool);
+
+#endif // KECCAK_XOF_H
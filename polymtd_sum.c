@@ -0,0 +1,531 @@
+// polymtd-sum: print PolyMTD digests of files, in the format of sha256sum.
+//
+// In plaintext mode (the default) the schedule is derived from the content,
+// so every input is read twice: the SHA-256 seed pass, then the sponge pass
+// under the derived schedule. Regular files are memory-mapped one window at
+// a time with MADV_SEQUENTIAL and a hugepage hint, and the next window is
+// read ahead while the current one is hashed; both passes read the page
+// cache in place and memory use is bounded by the window. Pipes and stdin
+// go through a double-buffered read() pipeline, a reader thread filling one
+// buffer while the other is hashed; in plaintext mode their content is
+// spooled to an unlinked temporary file during the seed pass and mapped for
+// the sponge pass. Keyed mode (-k) needs only the sponge pass; with -n the
+// schedule comes from the key and NONCE (MODE_KEY_NONCE). The one NONCE
+// applies to every input of the run, so all of them share that schedule,
+// and a digest does not depend on the order of the inputs; run the tool
+// once per nonce to give inputs schedules of their own.
+//
+//   polymtd-sum [-k KEY [-n NONCE]] [--tree] [--fast] [-j THREADS] [--read]
+//               [--stats FORMAT] [--trace OUT [--trace-blocks FIRST:COUNT]]
+//               [FILE...]
+//
+// With no FILE, or when FILE is -, standard input is read. --tree replaces
+// the sponge pass with the parallel tree mode of keccak_tree.h (a different
+// digest), hashed by THREADS workers (default: every online CPU). --fast
+// runs the KECCAK_ROUNDS_FAST-round permutation in the sponge pass, for
+// integrity checks that trade security margin for throughput (a different
+// digest again). --read uses the read() pipeline for regular files too.
+// --stats prometheus|json prints the engine statistics (keccak_stats.h) to
+// stderr once every input is hashed; they are zero unless the library was
+// built with -DKECCAK_STATS. --trace writes the execution trace of every
+// sponge pass to OUT (keccak_trace.h), one hash per input in order, for the
+// visualizer to replay; it runs the permutation step by step, so it is for
+// inspecting inputs, not for speed, and does not combine with --tree. A
+// traced block takes about 15 KB (over 100 times the input), so
+// --trace-blocks traces only COUNT blocks of each input from block FIRST
+// (counting from 0); the other blocks are hashed as usual and left out.
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // MADV_HUGEPAGE, posix_fadvise, mkstemp
+#elif !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // posix_fadvise, mkstemp under -std=c99
+#endif
+#define _FILE_OFFSET_BITS 64
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "keccak_stats.h"
+#include "keccak_trace.h"
+#include "keccak_tree.h"
+
+// Bytes mapped at a time; a multiple of any page size
+#define SUM_WINDOW (64u << 20)
+
+// Bytes per read() buffer; the pipeline holds two
+#define SUM_BUFFER (1u << 20)
+
+#define SUM_DIGEST 32
+
+// HASHING PASSES
+
+typedef void (*sum_consume_fn)(void *arg, const uint8_t *data, size_t len);
+
+typedef struct {
+    const char *key;         // keyed mode when not NULL
+    const char *nonce;       // key + nonce mode when not NULL (needs key)
+    int tree;                // tree mode instead of the plain sponge
+    int rounds;              // permutation rounds of the sponge pass
+    int force_read;
+    KeccakPool *pool;        // tree-mode workers
+    FILE *trace;             // trace output when not NULL
+    uint64_t trace_first;    // traced blocks of each input
+    uint64_t trace_count;
+} SumOptions;
+
+typedef struct {
+    SHA256_CTX sha;          // seed pass
+    KeccakSponge sponge;     // sponge pass
+    KeccakTree tree;         // sponge pass in tree mode
+    KeccakTrace trace;       // sponge pass while tracing
+    int tree_mode;
+    int trace_mode;
+    int spool;               // spool file fd during a spooling seed pass, else -1
+    uint64_t spooled;        // bytes written to the spool
+    int error;               // errno of a failed spool write
+} SumState;
+
+static void consume_seed(void *arg, const uint8_t *data, size_t len) {
+    SumState *st = (SumState*)arg;
+
+    sha256_update(&st->sha, data, len);
+    while (st->spool >= 0 && !st->error && len > 0) {
+        ssize_t n = write(st->spool, data, len);
+        if (n < 0) {
+            if (errno != EINTR) st->error = errno;
+            continue;
+        }
+        data += n;
+        len -= (size_t)n;
+        st->spooled += (uint64_t)n;
+    }
+}
+
+static void consume_sponge(void *arg, const uint8_t *data, size_t len) {
+    SumState *st = (SumState*)arg;
+
+    if (st->tree_mode) {
+        keccak_tree_update(&st->tree, data, len);
+    } else if (st->trace_mode) {
+        keccak_trace_update(&st->trace, data, len);
+    } else {
+        keccak_sponge_update(&st->sponge, data, len);
+    }
+}
+
+// Start the sponge pass once the schedule is known
+static void sponge_start(SumState *st, KeccakSchedule *schedule, const SumOptions *opt) {
+    PreparedSchedule prepared;
+
+    schedule_set_rounds(schedule, opt->rounds);
+    keccak_prepare_schedule(schedule, &prepared);
+    st->tree_mode = opt->tree;
+    st->trace_mode = opt->trace != NULL;
+    if (opt->tree) {
+        keccak_tree_init(&st->tree, &prepared, opt->pool);
+    } else if (opt->trace) {
+        keccak_trace_start(&st->trace, opt->trace, schedule);
+        keccak_trace_limit(&st->trace, opt->trace_first, opt->trace_count);
+    } else {
+        keccak_sponge_init_prepared(&st->sponge, &prepared);
+    }
+}
+
+static void sponge_finish(SumState *st, uint8_t digest[SUM_DIGEST]) {
+    if (st->tree_mode) {
+        keccak_tree_squeeze(&st->tree, digest, SUM_DIGEST);
+    } else if (st->trace_mode) {
+        keccak_trace_finish(&st->trace, digest, SUM_DIGEST);
+    } else {
+        keccak_sponge_squeeze(&st->sponge, digest, SUM_DIGEST);
+    }
+}
+
+// MEMORY-MAPPED INPUT
+
+// Feed size bytes of fd to consume, one mapped window at a time.
+// Returns 0, or -1 with errno set.
+static int map_pass(int fd, uint64_t size, sum_consume_fn consume, void *arg) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    for (uint64_t off = 0; off < size; off += SUM_WINDOW) {
+        size_t len = size - off < SUM_WINDOW ? (size_t)(size - off) : SUM_WINDOW;
+        void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, (off_t)off);
+
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+        // Hints only: failures (e.g. no transparent hugepages for this
+        // filesystem) are ignored
+        madvise(p, len, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        madvise(p, len, MADV_HUGEPAGE);
+#endif
+#ifdef POSIX_FADV_WILLNEED
+        // Start reading the next window while this one is hashed
+        if (off + len < size) {
+            posix_fadvise(fd, (off_t)(off + len), SUM_WINDOW, POSIX_FADV_WILLNEED);
+        }
+#endif
+        consume(arg, (const uint8_t*)p, len);
+        munmap(p, len);
+    }
+    return 0;
+}
+
+// READ() PIPELINE
+
+// Two buffers handed back and forth between the reader thread and the
+// hashing thread. full[i] is set by the reader once buf[i] holds data and
+// cleared by the hasher once it is consumed; final[i] marks the last buffer.
+typedef struct {
+    int fd;
+    uint8_t *buf[2];
+    size_t len[2];
+    int full[2];
+    int final[2];
+    int error;               // errno of a failed read()
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ReadPipe;
+
+// Read until the buffer is full or the input ends. Returns the byte count;
+// *error is set to errno on a read failure.
+static size_t read_fill(int fd, uint8_t *buf, size_t cap, int *error) {
+    size_t len = 0;
+
+    while (len < cap) {
+        ssize_t n = read(fd, buf + len, cap - len);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            *error = errno;
+            break;
+        }
+        len += (size_t)n;
+    }
+    return len;
+}
+
+static void *reader_main(void *arg) {
+    ReadPipe *rp = (ReadPipe*)arg;
+
+    for (int i = 0;; i ^= 1) {
+        int error = 0;
+
+        pthread_mutex_lock(&rp->lock);
+        while (rp->full[i]) {
+            pthread_cond_wait(&rp->cond, &rp->lock);
+        }
+        pthread_mutex_unlock(&rp->lock);
+
+        size_t len = read_fill(rp->fd, rp->buf[i], SUM_BUFFER, &error);
+
+        pthread_mutex_lock(&rp->lock);
+        rp->len[i] = len;
+        rp->final[i] = len < SUM_BUFFER;
+        rp->error = error;
+        rp->full[i] = 1;
+        pthread_cond_signal(&rp->cond);
+        pthread_mutex_unlock(&rp->lock);
+
+        if (len < SUM_BUFFER) {
+            return NULL;
+        }
+    }
+}
+
+// Feed fd to consume until end of input.
+// Returns 0, or -1 with errno set.
+static int pipe_pass(int fd, sum_consume_fn consume, void *arg) {
+    ReadPipe rp;
+    pthread_t reader;
+    int error;
+
+    memset(&rp, 0, sizeof(rp));
+    rp.fd = fd;
+    rp.buf[0] = (uint8_t*)malloc(2 * (size_t)SUM_BUFFER);
+    if (!rp.buf[0]) {
+        return -1;
+    }
+    rp.buf[1] = rp.buf[0] + SUM_BUFFER;
+    pthread_mutex_init(&rp.lock, NULL);
+    pthread_cond_init(&rp.cond, NULL);
+
+    if ((error = pthread_create(&reader, NULL, reader_main, &rp)) != 0) {
+        pthread_cond_destroy(&rp.cond);
+        pthread_mutex_destroy(&rp.lock);
+        free(rp.buf[0]);
+        errno = error;
+        return -1;
+    }
+
+    for (int i = 0;; i ^= 1) {
+        pthread_mutex_lock(&rp.lock);
+        while (!rp.full[i]) {
+            pthread_cond_wait(&rp.cond, &rp.lock);
+        }
+        int final = rp.final[i];
+        pthread_mutex_unlock(&rp.lock);
+
+        consume(arg, rp.buf[i], rp.len[i]);
+
+        pthread_mutex_lock(&rp.lock);
+        rp.full[i] = 0;
+        pthread_cond_signal(&rp.cond);
+        pthread_mutex_unlock(&rp.lock);
+
+        if (final) break;
+    }
+
+    pthread_join(reader, NULL);
+    error = rp.error;
+    pthread_cond_destroy(&rp.cond);
+    pthread_mutex_destroy(&rp.lock);
+    free(rp.buf[0]);
+
+    if (error) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
+
+// Unlinked temporary file in $TMPDIR (or /tmp) for spooling a pipe
+static int spool_open(void) {
+    const char *dir = getenv("TMPDIR");
+    char path[4096];
+    int fd;
+
+    if (!dir || !*dir) dir = "/tmp";
+    if (snprintf(path, sizeof(path), "%s/polymtd-sum.XXXXXX", dir) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    if ((fd = mkstemp(path)) >= 0) {
+        unlink(path);
+    }
+    return fd;
+}
+
+// DIGESTS
+
+// Hash one input. Returns 0, or -1 with errno set.
+static int sum_fd(int fd, const SumOptions *opt, uint8_t digest[SUM_DIGEST]) {
+    SumState st;
+    KeccakSchedule schedule;
+    struct stat info;
+    int regular, force_read = opt->force_read, result;
+
+    if (fstat(fd, &info) != 0) {
+        return -1;
+    }
+    regular = S_ISREG(info.st_mode);
+    st.spool = -1;
+    st.spooled = 0;
+    st.error = 0;
+
+    // Keyed modes: the schedule is known up front, one pass
+    if (opt->key) {
+        if (opt->nonce) {
+            generate_schedule_from_key_nonce(opt->key, (const uint8_t*)opt->nonce,
+                                             strlen(opt->nonce), &schedule);
+        } else {
+            generate_schedule_from_key(opt->key, &schedule);
+        }
+        sponge_start(&st, &schedule, opt);
+        result = regular && !force_read
+            ? map_pass(fd, (uint64_t)info.st_size, consume_sponge, &st)
+            : pipe_pass(fd, consume_sponge, &st);
+        if (result != 0) return -1;
+        sponge_finish(&st, digest);
+        return 0;
+    }
+
+    // Plaintext mode, seed pass. Inputs that cannot be read twice are
+    // spooled as they stream through.
+    if (regular && !force_read) {
+        st.sha = SHA256_MIDSTATE_MSG;
+        if (map_pass(fd, (uint64_t)info.st_size, consume_seed, &st) != 0) return -1;
+    } else {
+        if (!regular || lseek(fd, 0, SEEK_SET) != 0) {
+            if ((st.spool = spool_open()) < 0) return -1;
+        }
+        st.sha = SHA256_MIDSTATE_MSG;
+        result = pipe_pass(fd, consume_seed, &st);
+        if (result == 0 && st.error) {
+            errno = st.error;
+            result = -1;
+        }
+        if (result != 0) {
+            if (st.spool >= 0) close(st.spool);
+            return -1;
+        }
+    }
+    generate_schedule_from_sha256(&st.sha, MODE_PLAINTEXT, &schedule);
+    sponge_start(&st, &schedule, opt);
+
+    // Sponge pass
+    if (regular && !force_read) {
+        result = map_pass(fd, (uint64_t)info.st_size, consume_sponge, &st);
+    } else if (st.spool >= 0) {
+        result = map_pass(st.spool, st.spooled, consume_sponge, &st);
+        close(st.spool);
+    } else {
+        result = lseek(fd, 0, SEEK_SET) == 0 ? pipe_pass(fd, consume_sponge, &st) : -1;
+    }
+    if (result != 0) return -1;
+
+    sponge_finish(&st, digest);
+    return 0;
+}
+
+static int sum_path(const char *path, const SumOptions *opt) {
+    uint8_t digest[SUM_DIGEST];
+    int stdin_input = strcmp(path, "-") == 0;
+    int fd = stdin_input ? STDIN_FILENO : open(path, O_RDONLY);
+    int result;
+
+    if (fd < 0) {
+        fprintf(stderr, "polymtd-sum: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    result = sum_fd(fd, opt, digest);
+    if (result != 0) {
+        fprintf(stderr, "polymtd-sum: %s: %s\n", path, strerror(errno));
+    }
+    if (!stdin_input) {
+        close(fd);
+    }
+    if (result != 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < SUM_DIGEST; i++) {
+        printf("%02x", digest[i]);
+    }
+    printf("  %s\n", path);
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-k KEY [-n NONCE]] [--tree] [--fast] [-j THREADS] [--read] "
+            "[--stats prometheus|json] [--trace OUT [--trace-blocks FIRST:COUNT]] [FILE...]\n",
+            argv0);
+}
+
+// Parse FIRST:COUNT, two decimal numbers
+static int parse_range(const char *text, uint64_t *first, uint64_t *count) {
+    char *end;
+
+    if (text[0] < '0' || text[0] > '9') {
+        return -1;
+    }
+    *first = strtoull(text, &end, 10);
+    if (*end != ':' || end[1] < '0' || end[1] > '9') {
+        return -1;
+    }
+    *count = strtoull(end + 1, &end, 10);
+    return *end == '\0' ? 0 : -1;
+}
+
+// Print the statistics snapshot in format ("prometheus" or "json")
+static void print_stats(const char *format) {
+    size_t (*export)(const KeccakStats*, char*, size_t) =
+        strcmp(format, "json") == 0 ? keccak_stats_json : keccak_stats_prometheus;
+    KeccakStats stats;
+    size_t len;
+    char *text;
+
+    keccak_stats_snapshot(&stats);
+    len = export(&stats, NULL, 0);
+    if ((text = (char*)malloc(len + 1)) == NULL) {
+        return;
+    }
+    export(&stats, text, len + 1);
+    fputs(text, stderr);
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    SumOptions opt = {NULL, NULL, 0, KECCAK_ROUNDS_FULL, 0, NULL, NULL, 0, UINT64_MAX};
+    const char *stats_format = NULL, *trace_path = NULL, *trace_blocks = NULL;
+    int threads = 0, files = 0, status = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            opt.key = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            opt.nonce = argv[++i];
+        } else if (strcmp(argv[i], "--tree") == 0) {
+            opt.tree = 1;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            opt.rounds = KECCAK_ROUNDS_FAST;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--read") == 0) {
+            opt.force_read = 1;
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "prometheus") == 0 || strcmp(argv[i + 1], "json") == 0)) {
+            stats_format = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-blocks") == 0 && i + 1 < argc) {
+            trace_blocks = argv[++i];
+        } else if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            break;
+        }
+    }
+
+    if ((opt.nonce && !opt.key) || (trace_path && opt.tree) || (trace_blocks && !trace_path)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (trace_blocks && parse_range(trace_blocks, &opt.trace_first, &opt.trace_count) != 0) {
+        fprintf(stderr, "polymtd-sum: bad block range %s\n", trace_blocks);
+        return 1;
+    }
+
+    if (trace_path) {
+        if ((opt.trace = fopen(trace_path, "wb")) == NULL || keccak_trace_header(opt.trace) != 0) {
+            fprintf(stderr, "polymtd-sum: %s: %s\n", trace_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    if (opt.tree && threads != 1 && (opt.pool = keccak_pool_create(threads, 0)) == NULL) {
+        fprintf(stderr, "polymtd-sum: cannot start worker threads\n");
+        return 1;
+    }
+
+    for (; i < argc; i++, files++) {
+        if (sum_path(argv[i], &opt) != 0) status = 1;
+    }
+    if (files == 0 && sum_path("-", &opt) != 0) {
+        status = 1;
+    }
+    keccak_pool_destroy(opt.pool);
+    if (opt.trace && (ferror(opt.trace) | fclose(opt.trace)) != 0) {
+        fprintf(stderr, "polymtd-sum: %s: write error\n", trace_path);
+        status = 1;
+    }
+    if (stats_format) {
+        print_stats(stats_format);
+    }
+    return status;
+}
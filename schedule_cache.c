@@ -0,0 +1,220 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200112L // posix_memalign under -std=c99
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "schedule_cache.h"
+
+// Synchronization uses the GCC/Clang __atomic builtins, which are available
+// in C99 mode (unlike <stdatomic.h>).
+
+// SET SELECTION
+
+// Seeds are SHA-256 outputs, so their first bytes are already uniform
+static size_t seed_set(const ScheduleCache *cache, const uint8_t seed[32]) {
+    uint64_t h = 0;
+    for (int i = 0; i < 8; i++) {
+        h |= (uint64_t)seed[i] << (8 * i);
+    }
+    return (size_t)(h % cache->set_count);
+}
+
+// INITIALIZATION
+
+int schedule_cache_init(ScheduleCache *cache, size_t capacity) {
+    size_t set_count = (capacity + SCHEDULE_CACHE_WAYS - 1) / SCHEDULE_CACHE_WAYS;
+    if (set_count == 0) {
+        set_count = 1;
+    }
+
+    // Aligned so every set's counters sit on their own cache line
+    void *memory = NULL;
+    if (posix_memalign(&memory, 64, set_count * sizeof(ScheduleCacheSet)) != 0) {
+        return -1;
+    }
+    memset(memory, 0, set_count * sizeof(ScheduleCacheSet));
+    cache->sets = (ScheduleCacheSet*)memory;
+    cache->set_count = set_count;
+    return 0;
+}
+
+void schedule_cache_free(ScheduleCache *cache) {
+    free(cache->sets);
+    cache->sets = NULL;
+    cache->set_count = 0;
+}
+
+// LOOKUP
+
+// Optimistic read of one way: copy, then check the sequence did not move.
+// Returns 1 if the way holds seed (and out was filled), 0 otherwise.
+static int entry_read(ScheduleCacheEntry *e, const uint8_t seed[32], PreparedSchedule *out) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) {
+            return 0;
+        }
+        if (seq & 1) {
+            continue;                       // writer in progress
+        }
+
+        uint8_t tag[32];
+        memcpy(tag, e->seed, 32);
+        int match = memcmp(tag, seed, 32) == 0;
+        if (match) {
+            memcpy(out, &e->prepared, sizeof(*out));
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) == seq) {
+            return match;
+        }
+    }
+}
+
+int schedule_cache_lookup(ScheduleCache *cache, const uint8_t seed[32], PreparedSchedule *out) {
+    ScheduleCacheSet *set = &cache->sets[seed_set(cache, seed)];
+
+    for (int w = 0; w < SCHEDULE_CACHE_WAYS; w++) {
+        ScheduleCacheEntry *e = &set->ways[w];
+        if (entry_read(e, seed, out)) {
+            // Only write the shared line when the bit actually changes
+            if (!__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&e->referenced, 1, __ATOMIC_RELAXED);
+            }
+            __atomic_fetch_add(&set->counters.hits, 1, __ATOMIC_RELAXED);
+            return 1;
+        }
+    }
+
+    __atomic_fetch_add(&set->counters.misses, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// INSERTION
+
+// Spin-wait hint: lets the sibling hyperthread run and avoids the
+// pipeline flush on memory-order mis-speculation when the lock is released
+static inline void spin_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield");
+#endif
+}
+
+static void set_lock(ScheduleCacheSet *set) {
+    while (__atomic_exchange_n(&set->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&set->lock, __ATOMIC_RELAXED)) {
+            spin_pause();
+        }
+    }
+}
+
+static void set_unlock(ScheduleCacheSet *set) {
+    __atomic_store_n(&set->lock, 0, __ATOMIC_RELEASE);
+}
+
+// CLOCK: take an empty way if there is one, otherwise sweep from the hand,
+// giving referenced ways a second chance. Called with the set locked.
+static ScheduleCacheEntry *set_victim(ScheduleCacheSet *set, int *evicted) {
+    for (int w = 0; w < SCHEDULE_CACHE_WAYS; w++) {
+        if (set->ways[w].seq == 0) {
+            *evicted = 0;
+            return &set->ways[w];
+        }
+    }
+
+    for (;;) {
+        ScheduleCacheEntry *e = &set->ways[set->hand];
+        set->hand = (set->hand + 1) % SCHEDULE_CACHE_WAYS;
+        if (__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&e->referenced, 0, __ATOMIC_RELAXED);
+        } else {
+            *evicted = 1;
+            return e;
+        }
+    }
+}
+
+void schedule_cache_insert(ScheduleCache *cache, const uint8_t seed[32],
+                           const PreparedSchedule *prepared) {
+    ScheduleCacheSet *set = &cache->sets[seed_set(cache, seed)];
+
+    set_lock(set);
+
+    // Another thread may have derived the same seed concurrently
+    for (int w = 0; w < SCHEDULE_CACHE_WAYS; w++) {
+        ScheduleCacheEntry *e = &set->ways[w];
+        if (e->seq != 0 && memcmp(e->seed, seed, 32) == 0) {
+            set_unlock(set);
+            return;
+        }
+    }
+
+    int evicted;
+    ScheduleCacheEntry *e = set_victim(set, &evicted);
+    uint32_t seq = e->seq;
+
+    __atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(e->seed, seed, 32);
+    memcpy(&e->prepared, prepared, sizeof(*prepared));
+    __atomic_store_n(&e->referenced, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->seq, seq + 2, __ATOMIC_RELEASE);
+
+    set_unlock(set);
+
+    if (evicted) {
+        __atomic_fetch_add(&set->counters.evictions, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// GET-OR-DERIVE
+
+void schedule_cache_prepare_seed(ScheduleCache *cache, const uint8_t seed[32],
+                                 PreparedSchedule *out) {
+    if (schedule_cache_lookup(cache, seed, out)) {
+        return;
+    }
+
+    // Derive outside the lock; generated schedules are always valid
+    KeccakSchedule schedule;
+    generate_schedule_internal(seed, &schedule);
+    keccak_prepare_schedule(&schedule, out);
+    schedule_cache_insert(cache, seed, out);
+}
+
+void schedule_cache_prepare_key(ScheduleCache *cache, const uint8_t *key, size_t key_len,
+                                PreparedSchedule *out) {
+    SHA256_CTX ctx = SHA256_MIDSTATE_KEY;
+    uint8_t seed[32];
+
+    sha256_update(&ctx, key, key_len);
+    sha256_final(&ctx, seed);
+    schedule_cache_prepare_seed(cache, seed, out);
+}
+
+void schedule_cache_prepare_binary(ScheduleCache *cache, const uint8_t *data, size_t data_len,
+                                   PreparedSchedule *out) {
+    SHA256_CTX ctx = SHA256_MIDSTATE_MSG;
+    uint8_t seed[32];
+
+    sha256_update(&ctx, data, data_len);
+    sha256_final(&ctx, seed);
+    schedule_cache_prepare_seed(cache, seed, out);
+}
+
+// STATISTICS
+
+void schedule_cache_stats(const ScheduleCache *cache, ScheduleCacheStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (size_t i = 0; i < cache->set_count; i++) {
+        const ScheduleCacheCounters *c = &cache->sets[i].counters;
+        stats->hits += __atomic_load_n(&c->hits, __ATOMIC_RELAXED);
+        stats->misses += __atomic_load_n(&c->misses, __ATOMIC_RELAXED);
+        stats->evictions += __atomic_load_n(&c->evictions, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef SCHEDULE_CACHE_H
+#define SCHEDULE_CACHE_H
+
+#include <stddef.h>
+#include "keccak_engine.h"
+
+// Entries per set; a seed can only live in the set its first bytes select
+#define SCHEDULE_CACHE_WAYS 8
+
+// One cached prepared schedule. seq is a per-entry sequence lock: odd while
+// a writer is replacing the entry, 0 while the entry has never been filled.
+typedef struct {
+    uint32_t seq;
+    uint8_t referenced;      // CLOCK bit, set by readers on a hit
+    uint8_t seed[32];
+    PreparedSchedule prepared;
+} ScheduleCacheEntry;
+
+// Hit/miss/eviction counts of one set, on a cache line of their own so
+// that counting never contends with the lock or with other sets.
+// schedule_cache_stats() sums them over all sets.
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} __attribute__((aligned(64))) ScheduleCacheCounters;
+
+typedef struct {
+    ScheduleCacheCounters counters;
+    uint32_t lock;           // serializes writers of this set only
+    uint32_t hand;           // CLOCK hand over the ways
+    ScheduleCacheEntry ways[SCHEDULE_CACHE_WAYS];
+} ScheduleCacheSet;
+
+// Fixed-size cache of prepared schedules keyed by their 32-byte seed.
+// Lookups take no lock: they read an entry optimistically and retry if a
+// writer replaced it meanwhile. Misses derive the schedule outside any lock
+// and insert it, evicting with CLOCK within the seed's set.
+typedef struct {
+    ScheduleCacheSet *sets;
+    size_t set_count;
+} ScheduleCache;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} ScheduleCacheStats;
+
+// Allocate a cache holding at least `capacity` schedules.
+// Returns 0 on success, -1 on allocation failure.
+int schedule_cache_init(ScheduleCache *cache, size_t capacity);
+
+// Release the cache memory; no other thread may be using it
+void schedule_cache_free(ScheduleCache *cache);
+
+// Copy the prepared schedule for seed into out if it is cached.
+// Returns 1 on a hit, 0 on a miss. Safe to call from any number of threads.
+int schedule_cache_lookup(ScheduleCache *cache, const uint8_t seed[32], PreparedSchedule *out);
+
+// Insert a prepared schedule (no effect if the seed is already cached)
+void schedule_cache_insert(ScheduleCache *cache, const uint8_t seed[32],
+                           const PreparedSchedule *prepared);
+
+// Get-or-derive: on a miss the schedule is generated from the seed,
+// prepared and inserted. Hits cost a lookup and a copy.
+void schedule_cache_prepare_seed(ScheduleCache *cache, const uint8_t seed[32],
+                                 PreparedSchedule *out);
+
+// MODE_KEY / MODE_PLAINTEXT front ends: the seed is hashed from the domain
+// midstate (for short keys a single SHA-256 block), then looked up
+void schedule_cache_prepare_key(ScheduleCache *cache, const uint8_t *key, size_t key_len,
+                                PreparedSchedule *out);
+void schedule_cache_prepare_binary(ScheduleCache *cache, const uint8_t *data, size_t data_len,
+                                   PreparedSchedule *out);
+
+// Snapshot of the hit/miss/eviction counters, summed over the sets
+void schedule_cache_stats(const ScheduleCache *cache, ScheduleCacheStats *stats);
+
+#endif // SCHEDULE_CACHE_H
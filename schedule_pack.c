@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include "schedule_pack.h"
+#include "keccak_engine.h"
+
+// OR value (at most 13 bits) into the bit string at bit
+static void put_bits(PackedSchedule *packed, unsigned bit, unsigned value) {
+    for (unsigned i = 0; value >> i != 0; i++) {
+        if ((value >> i) & 1u) {
+            packed->bytes[(bit + i) / 8] |= (uint8_t)(1u << ((bit + i) % 8));
+        }
+    }
+}
+
+// Header and every round in range, unused bits 0. Packed schedules are
+// canonical, so two of them hold the same schedule exactly when their bytes
+// are equal.
+static int packed_is_valid(const PackedSchedule *packed) {
+    int n = schedule_packed_rounds(packed);
+    PackedSchedule used;
+
+    if (n < 1 || n > KECCAK_ROUNDS_FULL || (packed->bytes[0] & 0x80) != 0 ||
+        schedule_packed_mode(packed) > MODE_KEY_NONCE) {
+        return 0;
+    }
+
+    memset(&used, 0, sizeof(used));
+    used.bytes[0] = packed->bytes[0];
+    for (int r = 0; r < n; r++) {
+        unsigned bits = schedule_packed_round(packed, r);
+
+        if (SCHEDULE_PACK_THETA(bits) >= KECCAK_VARIANTS ||
+            SCHEDULE_PACK_RHOPI(bits) >= KECCAK_VARIANTS ||
+            SCHEDULE_PACK_CHI(bits) >= KECCAK_VARIANTS ||
+            SCHEDULE_PACK_IOTA(bits) >= KECCAK_VARIANTS) {
+            return 0;
+        }
+        put_bits(&used, SCHEDULE_PACK_HEADER_BITS + (unsigned)r * SCHEDULE_PACK_ROUND_BITS, bits);
+    }
+    return memcmp(&used, packed, sizeof(used)) == 0;
+}
+
+// PACKING
+
+int schedule_pack(const KeccakSchedule *schedule, PackedSchedule *packed) {
+    int n = schedule->num_rounds;
+
+    if (n < 1 || n > KECCAK_ROUNDS_FULL ||
+        (unsigned)schedule->mode > (unsigned)MODE_KEY_NONCE) {
+        return -1;
+    }
+    memset(packed, 0, sizeof(*packed));
+    packed->bytes[0] = (uint8_t)(n | ((unsigned)schedule->mode << 5));
+
+    for (int r = 0; r < n; r++) {
+        const RoundSchedule *rs = &schedule->rounds[r];
+        int order;
+
+        if (rs->step_order[0] == STEP_THETA && rs->step_order[1] == STEP_RHOPI) {
+            order = 0;
+        } else if (rs->step_order[0] == STEP_RHOPI && rs->step_order[1] == STEP_THETA) {
+            order = 1;
+        } else {
+            return -1;
+        }
+        if (rs->step_order[2] != STEP_CHI || rs->step_order[3] != STEP_IOTA) {
+            return -1;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (rs->variants[i] < 0 || rs->variants[i] >= KECCAK_VARIANTS) {
+                return -1;
+            }
+        }
+
+        // variants[i] belongs to the step at position i; packed fields are
+        // per step
+        unsigned theta = (unsigned)rs->variants[order];
+        unsigned rhopi = (unsigned)rs->variants[1 - order];
+        unsigned bits = (unsigned)order | theta << 1 | rhopi << 4 |
+                        (unsigned)rs->variants[2] << 7 | (unsigned)rs->variants[3] << 10;
+        put_bits(packed, SCHEDULE_PACK_HEADER_BITS + (unsigned)r * SCHEDULE_PACK_ROUND_BITS, bits);
+    }
+    return 0;
+}
+
+int schedule_unpack(const PackedSchedule *packed, KeccakSchedule *schedule) {
+    if (!packed_is_valid(packed)) {
+        return -1;
+    }
+    memset(schedule, 0, sizeof(*schedule));
+    schedule->num_rounds = schedule_packed_rounds(packed);
+    schedule->mode = schedule_packed_mode(packed);
+
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        RoundSchedule *rs = &schedule->rounds[r];
+        unsigned bits = schedule_packed_round(packed, r);
+        int order = (int)SCHEDULE_PACK_ORDER(bits);
+
+        rs->step_order[0] = order == 0 ? STEP_THETA : STEP_RHOPI;
+        rs->step_order[1] = order == 0 ? STEP_RHOPI : STEP_THETA;
+        rs->step_order[2] = STEP_CHI;
+        rs->step_order[3] = STEP_IOTA;
+        rs->variants[order] = (int)SCHEDULE_PACK_THETA(bits);
+        rs->variants[1 - order] = (int)SCHEDULE_PACK_RHOPI(bits);
+        rs->variants[2] = (int)SCHEDULE_PACK_CHI(bits);
+        rs->variants[3] = (int)SCHEDULE_PACK_IOTA(bits);
+    }
+    return 0;
+}
+
+// SERIALIZATION
+
+void schedule_pack_serialize(const PackedSchedule *packed, uint8_t out[SCHEDULE_PACK_SERIAL]) {
+    out[0] = SCHEDULE_PACK_VERSION;
+    memcpy(out + 1, packed->bytes, SCHEDULE_PACKED_BYTES);
+}
+
+int schedule_pack_deserialize(const uint8_t *in, size_t len, PackedSchedule *packed) {
+    PackedSchedule read;
+
+    if (len < SCHEDULE_PACK_SERIAL || in[0] != SCHEDULE_PACK_VERSION) {
+        return -1;
+    }
+    memcpy(read.bytes, in + 1, SCHEDULE_PACKED_BYTES);
+    if (!packed_is_valid(&read)) {
+        return -1;
+    }
+    *packed = read;
+    return 0;
+}
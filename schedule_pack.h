@@ -0,0 +1,89 @@
+#ifndef SCHEDULE_PACK_H
+#define SCHEDULE_PACK_H
+
+#include <stddef.h>
+#include "seed_generation.h"
+
+// Packed schedules: the information of a KeccakSchedule in 40 bytes instead
+// of about 800, for caches and stores holding very many schedules.
+//
+// A round has one degree of freedom in its order (θ/ρπ swapped or not; χ
+// and ι are always last) and four variants of 0-6, so it fits 13 bits:
+//     bit 0       order (0 = θ first, 1 = ρπ first)
+//     bits 1-3    theta variant
+//     bits 4-6    rhopi variant
+//     bits 7-9    chi variant
+//     bits 10-12  iota variant
+// Bit b of the packed bit string is bit b % 8 of bytes[b / 8]:
+//     bits 0-4    num_rounds (1..KECCAK_ROUNDS_FULL)
+//     bits 5-6    mode (ScheduleMode)
+//     bit 7       reserved, 0
+//     bits 8 + 13r .. 20 + 13r   round r, for r < num_rounds; later rounds 0
+// The layout is byte-oriented, so the bytes are the same on every host and
+// an array of PackedSchedules has no padding. The seed is not kept.
+
+#define SCHEDULE_PACKED_BYTES 40
+
+// Serialized form: SCHEDULE_PACK_VERSION, then the SCHEDULE_PACKED_BYTES
+// bytes. A new layout gets a new version; readers reject versions they do
+// not know.
+#define SCHEDULE_PACK_VERSION 1
+#define SCHEDULE_PACK_SERIAL  (1 + SCHEDULE_PACKED_BYTES)
+
+#define SCHEDULE_PACK_ROUND_BITS  13
+#define SCHEDULE_PACK_HEADER_BITS 8
+
+#if SCHEDULE_PACK_HEADER_BITS + KECCAK_ROUNDS_FULL * SCHEDULE_PACK_ROUND_BITS > \
+    8 * SCHEDULE_PACKED_BYTES
+#error "SCHEDULE_PACKED_BYTES is too small for KECCAK_ROUNDS_FULL rounds"
+#endif
+
+// Fields of a round's 13 bits
+#define SCHEDULE_PACK_ORDER(bits) ((bits) & 0x1u)
+#define SCHEDULE_PACK_THETA(bits) (((bits) >> 1) & 0x7u)
+#define SCHEDULE_PACK_RHOPI(bits) (((bits) >> 4) & 0x7u)
+#define SCHEDULE_PACK_CHI(bits)   (((bits) >> 7) & 0x7u)
+#define SCHEDULE_PACK_IOTA(bits)  (((bits) >> 10) & 0x7u)
+
+typedef struct {
+    uint8_t bytes[SCHEDULE_PACKED_BYTES];
+} PackedSchedule;
+
+// Header fields
+static inline int schedule_packed_rounds(const PackedSchedule *packed) {
+    return packed->bytes[0] & 0x1F;
+}
+
+static inline ScheduleMode schedule_packed_mode(const PackedSchedule *packed) {
+    return (ScheduleMode)((packed->bytes[0] >> 5) & 0x3);
+}
+
+// The 13 bits of round r. A field spans at most three bytes (7 + 13 bits).
+static inline unsigned schedule_packed_round(const PackedSchedule *packed, int r) {
+    unsigned bit = SCHEDULE_PACK_HEADER_BITS + (unsigned)r * SCHEDULE_PACK_ROUND_BITS;
+    const uint8_t *p = packed->bytes + bit / 8;
+    uint32_t window = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+
+    if (bit / 8 + 2 < SCHEDULE_PACKED_BYTES) {
+        window |= (uint32_t)p[2] << 16;
+    }
+    return (window >> (bit % 8)) & ((1u << SCHEDULE_PACK_ROUND_BITS) - 1);
+}
+
+// Pack a schedule. Returns 0, or -1 if it holds an invalid round count,
+// step order or variant (as keccak_prepare_schedule would reject).
+int schedule_pack(const KeccakSchedule *schedule, PackedSchedule *packed);
+
+// Expand a packed schedule; the seed is zeroed. Returns 0, or -1 if a field
+// is out of range. keccak_prepare_packed (keccak_engine.h) goes straight to
+// a PreparedSchedule instead.
+int schedule_unpack(const PackedSchedule *packed, KeccakSchedule *schedule);
+
+// Write the versioned serialized form
+void schedule_pack_serialize(const PackedSchedule *packed, uint8_t out[SCHEDULE_PACK_SERIAL]);
+
+// Read a serialized schedule of len bytes. Returns 0, or -1 on a short
+// buffer, an unknown version or out-of-range fields.
+int schedule_pack_deserialize(const uint8_t *in, size_t len, PackedSchedule *packed);
+
+#endif // SCHEDULE_PACK_H
@@ -0,0 +1,279 @@
+#include <string.h>
+
+#include "seed_batch.h"
+#include "cpu_dispatch.h"
+#include "keccak_stats.h"
+
+// SIMD WORD TYPES
+
+// The multi-buffer kernels hold word t of every stream in one vector, so one
+// instruction advances all streams by the same step. Like the Keccak batch
+// kernels they are compiled for their ISA and selected at run time.
+
+#if defined(__GNUC__) && (defined(__AVX512F__) || defined(CPU_MULTI_ISA))
+#define SEED_BATCH_X16 1
+typedef uint32_t word_x16 __attribute__((vector_size(64)));
+#endif
+
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(CPU_MULTI_ISA))
+#define SEED_BATCH_X8 1
+typedef uint32_t word_x8 __attribute__((vector_size(32)));
+#endif
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define SIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define GAMMA0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+// LANE STREAMS
+
+#if defined(SEED_BATCH_X16) || defined(SEED_BATCH_X8)
+
+// One message in flight on a SIMD lane. The lane hashes the virtual stream
+// start->block || msg || padding without materializing it: interior blocks
+// are read from the message in place, only the first and last blocks are
+// assembled in a scratch buffer.
+typedef struct {
+    const uint8_t *msg;
+    size_t len;
+    size_t block;        // next block to compress
+    size_t blocks;       // total blocks including prefix and padding
+    size_t index;        // message number, digest destination
+} LaneStream;
+
+static void lane_stream_start(LaneStream *ls, const SHA256_CTX *start, const uint8_t *msg,
+                              size_t len, size_t index) {
+    ls->msg = msg;
+    ls->len = len;
+    ls->block = 0;
+    ls->blocks = (start->block_len + len + 9 + 63) / 64;
+    ls->index = index;
+}
+
+static const uint8_t *lane_stream_block(const LaneStream *ls, const SHA256_CTX *start,
+                                        uint8_t scratch[64]) {
+    size_t prefix = start->block_len;
+    size_t off = ls->block * 64;
+
+    if (off >= prefix && off - prefix + 64 <= ls->len) {
+        return ls->msg + (off - prefix);
+    }
+
+    // Edge block: separator prefix, message bytes, 0x80 and zero padding
+    size_t fill = 0;
+    memset(scratch, 0, 64);
+    if (off < prefix) {
+        fill = prefix - off < 64 ? prefix - off : 64;
+        memcpy(scratch, start->block + off, fill);
+    }
+    if (fill < 64 && off + fill - prefix < ls->len) {
+        size_t from = off + fill - prefix;
+        size_t take = ls->len - from < 64 - fill ? ls->len - from : 64 - fill;
+        memcpy(scratch + fill, ls->msg + from, take);
+        fill += take;
+    }
+    if (fill < 64 && off + fill - prefix == ls->len) {
+        scratch[fill] = 0x80;
+    }
+
+    // Append length in big-endian
+    if (ls->block == ls->blocks - 1) {
+        uint64_t bit_len = (start->total_len + ls->len) * 8;
+        for (int i = 0; i < 8; i++) {
+            scratch[56 + i] = (bit_len >> (56 - i * 8)) & 0xff;
+        }
+    }
+    return scratch;
+}
+
+static inline uint32_t load32_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+#endif
+
+// MULTI-BUFFER KERNELS
+
+// sha256_compress_xW runs one block of each of W streams; sha256_batch_xW
+// keeps W lanes busy, refilling each lane from the message list as soon as
+// its stream ends. It returns once every message has been hashed.
+#define DEFINE_SHA256_BATCH(W)                                               \
+    static void sha256_compress_x##W(word_x##W H[8],                         \
+                                     const uint8_t *const block[W]) {        \
+        word_x##W M[64];                                                     \
+                                                                             \
+        for (int t = 0; t < 16; t++) {                                       \
+            for (int j = 0; j < W; j++) {                                    \
+                M[t][j] = load32_be(block[j] + t * 4);                       \
+            }                                                                \
+        }                                                                    \
+        for (int t = 16; t < 64; t++) {                                      \
+            M[t] = GAMMA1(M[t-2]) + M[t-7] + GAMMA0(M[t-15]) + M[t-16];      \
+        }                                                                    \
+                                                                             \
+        word_x##W a = H[0], b = H[1], c = H[2], d = H[3];                    \
+        word_x##W e = H[4], f = H[5], g = H[6], h = H[7];                    \
+                                                                             \
+        for (int t = 0; t < 64; t++) {                                       \
+            word_x##W T1 = h + SIG1(e) + CH(e, f, g) + SHA256_K[t] + M[t];   \
+            word_x##W T2 = SIG0(a) + MAJ(a, b, c);                           \
+            h = g; g = f; f = e; e = d + T1;                                 \
+            d = c; c = b; b = a; a = T1 + T2;                                \
+        }                                                                    \
+                                                                             \
+        H[0] += a; H[1] += b; H[2] += c; H[3] += d;                          \
+        H[4] += e; H[5] += f; H[6] += g; H[7] += h;                          \
+    }                                                                        \
+                                                                             \
+    static void sha256_batch_x##W(const SHA256_CTX *start,                   \
+                                  const uint8_t *const *msgs,                \
+                                  const size_t *lens, size_t n,              \
+                                  uint8_t (*digests)[32]) {                  \
+        LaneStream lanes[W];                                                 \
+        uint8_t scratch[W][64];                                              \
+        const uint8_t *block[W];                                             \
+        word_x##W H[8];                                                      \
+        int active[W];                                                       \
+        int running = 0;                                                     \
+        size_t next = 0;                                                     \
+                                                                             \
+        memset(H, 0, sizeof(H));                                             \
+        memset(scratch, 0, sizeof(scratch));                                 \
+        for (int j = 0; j < W; j++) {                                        \
+            active[j] = next < n;                                            \
+            if (active[j]) {                                                 \
+                lane_stream_start(&lanes[j], start, msgs[next],              \
+                                  lens[next], next);                         \
+                for (int i = 0; i < 8; i++) H[i][j] = start->H[i];           \
+                next++;                                                      \
+                running++;                                                   \
+            }                                                                \
+        }                                                                    \
+                                                                             \
+        while (running > 0) {                                                \
+            for (int j = 0; j < W; j++) {                                    \
+                block[j] = active[j]                                         \
+                    ? lane_stream_block(&lanes[j], start, scratch[j])        \
+                    : scratch[j];                                            \
+            }                                                                \
+            sha256_compress_x##W(H, block);                                  \
+                                                                             \
+            for (int j = 0; j < W; j++) {                                    \
+                if (!active[j] || ++lanes[j].block < lanes[j].blocks) {     \
+                    continue;                                                \
+                }                                                            \
+                uint8_t *out = digests[lanes[j].index];                      \
+                for (int i = 0; i < 8; i++) {                                \
+                    out[i * 4] = (H[i][j] >> 24) & 0xff;                     \
+                    out[i * 4 + 1] = (H[i][j] >> 16) & 0xff;                 \
+                    out[i * 4 + 2] = (H[i][j] >> 8) & 0xff;                  \
+                    out[i * 4 + 3] = H[i][j] & 0xff;                         \
+                    H[i][j] = start->H[i];                                   \
+                }                                                            \
+                if (next < n) {                                              \
+                    lane_stream_start(&lanes[j], start, msgs[next],          \
+                                      lens[next], next);                     \
+                    next++;                                                  \
+                } else {                                                     \
+                    active[j] = 0;                                           \
+                    running--;                                               \
+                }                                                            \
+            }                                                                \
+        }                                                                    \
+    }
+
+#ifdef SEED_BATCH_X16
+CPU_TARGET_BEGIN("avx512f")
+DEFINE_SHA256_BATCH(16)
+CPU_TARGET_END
+#endif
+
+#ifdef SEED_BATCH_X8
+CPU_TARGET_BEGIN("avx2")
+DEFINE_SHA256_BATCH(8)
+CPU_TARGET_END
+#endif
+
+// PUBLIC API
+
+int sha256_batch_width(void) {
+    unsigned features = cpu_features();
+
+    (void)features;
+#ifdef SEED_BATCH_X16
+    if (features & CPU_AVX512) return 16;
+#endif
+#ifdef SEED_BATCH_X8
+    if (features & CPU_AVX2) return 8;
+#endif
+    return 1;
+}
+
+#if defined(KECCAK_STATS) && (defined(SEED_BATCH_X16) || defined(SEED_BATCH_X8))
+// Blocks compressed for n messages, as counted by the single-stream path
+static uint64_t batch_blocks(const SHA256_CTX *start, const size_t *lens, size_t n) {
+    uint64_t blocks = 0;
+    for (size_t j = 0; j < n; j++) {
+        blocks += (start->block_len + lens[j] + 9 + 63) / 64;
+    }
+    return blocks;
+}
+#endif
+
+void sha256_batch(const SHA256_CTX *start, const uint8_t *const *msgs, const size_t *lens,
+                  size_t n, uint8_t (*digests)[32]) {
+    unsigned features = cpu_features();
+
+    (void)features;
+    if (n == 0) {
+        return;
+    }
+#if defined(SEED_BATCH_X16)
+    if (n >= 16 && (features & CPU_AVX512)) {
+        KECCAK_STATS_ONLY(uint64_t blocks = batch_blocks(start, lens, n);)
+        KECCAK_STATS_START(t);
+        sha256_batch_x16(start, msgs, lens, n, digests);
+        KECCAK_STATS_SHA256(blocks, t);
+        return;
+    }
+#endif
+#if defined(SEED_BATCH_X8)
+    // Without rotates the 8-lane kernel is slower than SHA-NI on one stream
+    if (n >= 8 && (features & CPU_AVX2) && !(features & CPU_SHANI)) {
+        KECCAK_STATS_ONLY(uint64_t blocks = batch_blocks(start, lens, n);)
+        KECCAK_STATS_START(t);
+        sha256_batch_x8(start, msgs, lens, n, digests);
+        KECCAK_STATS_SHA256(blocks, t);
+        return;
+    }
+#endif
+    // Too few streams to fill a vector, or SHA-NI is faster: one stream at a time
+    for (size_t j = 0; j < n; j++) {
+        SHA256_CTX ctx = *start;
+        sha256_update(&ctx, msgs[j], lens[j]);
+        sha256_final(&ctx, digests[j]);
+    }
+}
+
+// Digests are produced in chunks so the seeds need no heap buffer
+#define SCHEDULE_BATCH_CHUNK 64
+
+void generate_schedules_batch(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                              KeccakSchedule *out) {
+    uint8_t seeds[SCHEDULE_BATCH_CHUNK][32];
+
+    for (size_t base = 0; base < n; base += SCHEDULE_BATCH_CHUNK) {
+        size_t count = n - base < SCHEDULE_BATCH_CHUNK ? n - base : SCHEDULE_BATCH_CHUNK;
+
+        // seed = SHA256(domain_separator || msg), separator pre-absorbed
+        sha256_batch(&SHA256_MIDSTATE_MSG, msgs + base, lens + base, count, seeds);
+        for (size_t j = 0; j < count; j++) {
+            out[base + j].mode = MODE_PLAINTEXT;
+            generate_schedule_internal(seeds[j], &out[base + j]);
+        }
+    }
+}
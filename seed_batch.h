@@ -0,0 +1,25 @@
+#ifndef SEED_BATCH_H
+#define SEED_BATCH_H
+
+#include <stddef.h>
+#include "seed_generation.h"
+
+// Number of SHA-256 streams hashed side by side (see cpu_dispatch.h):
+// 16 with AVX-512F, 8 with AVX2, 1 when only the single-stream path is used.
+// The 8-lane kernel is skipped at run time on CPUs with SHA-NI, which
+// hashes a single stream faster.
+int sha256_batch_width(void);
+
+// Hash n independent messages, each continuing from the same start context
+// (e.g. a domain midstate). digests[j] is bit-identical to copying *start,
+// sha256_update(msgs[j], lens[j]) and sha256_final. Streams are interleaved
+// across SIMD lanes; a lane that finishes picks up the next message.
+void sha256_batch(const SHA256_CTX *start, const uint8_t *const *msgs, const size_t *lens,
+                  size_t n, uint8_t (*digests)[32]);
+
+// Derive n plaintext-mode schedules at once; out[j] equals
+// generate_schedule_from_binary(msgs[j], lens[j], &out[j]).
+void generate_schedules_batch(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                              KeccakSchedule *out);
+
+#endif // SEED_BATCH_H
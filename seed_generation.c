@@ -1,425 +1,882 @@
-#include "seed_generation.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-// SHA-256 IMPLEMENTATION
-
-// SHA-256 constants
-static const uint32_t K[64] = {
-    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-};
-
-#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
-#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
-#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
-#define SIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
-#define SIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
-#define GAMMA0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
-#define GAMMA1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
-
-void sha256(const uint8_t *input, size_t len, uint8_t output[32]) {
-    uint32_t H[8] = {
-        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-    };
-    
-    // Calculate padding
-    uint64_t bit_len = len * 8;
-    // Need: message + 0x80 + padding_zeros such that total ≡ 56 (mod 64), then + 8 bytes for length
-    size_t total_len = len + 1; // message + 0x80
-    while ((total_len % 64) != 56) total_len++; // add zeros to reach 56 mod 64
-    total_len += 8; // add 8-byte length field
-    
-    uint8_t *padded = (uint8_t*)malloc(total_len);
-    memcpy(padded, input, len);
-    padded[len] = 0x80;
-    memset(padded + len + 1, 0, total_len - len - 9); // zeros
-    
-    // Append length in big-endian
-    for (int i = 0; i < 8; i++) {
-        padded[total_len - 8 + i] = (bit_len >> (56 - i * 8)) & 0xff;
-    }
-    
-    // Process blocks
-    for (size_t offset = 0; offset < total_len; offset += 64) {
-        uint32_t W[64];
-        
-        // Prepare message schedule
-        for (int t = 0; t < 16; t++) {
-            W[t] = ((uint32_t)padded[offset + t * 4] << 24) |
-                   ((uint32_t)padded[offset + t * 4 + 1] << 16) |
-                   ((uint32_t)padded[offset + t * 4 + 2] << 8) |
-                   ((uint32_t)padded[offset + t * 4 + 3]);
-        }
-        for (int t = 16; t < 64; t++) {
-            W[t] = GAMMA1(W[t-2]) + W[t-7] + GAMMA0(W[t-15]) + W[t-16];
-        }
-        
-        // Initialize working variables
-        uint32_t a = H[0], b = H[1], c = H[2], d = H[3];
-        uint32_t e = H[4], f = H[5], g = H[6], h = H[7];
-        
-        // Main loop
-        for (int t = 0; t < 64; t++) {
-            uint32_t T1 = h + SIG1(e) + CH(e, f, g) + K[t] + W[t];
-            uint32_t T2 = SIG0(a) + MAJ(a, b, c);
-            h = g; g = f; f = e; e = d + T1;
-            d = c; c = b; b = a; a = T1 + T2;
-        }
-        
-        // Update hash values
-        H[0] += a; H[1] += b; H[2] += c; H[3] += d;
-        H[4] += e; H[5] += f; H[6] += g; H[7] += h;
-    }
-    
-    // Convert to byte array
-    for (int i = 0; i < 8; i++) {
-        output[i * 4] = (H[i] >> 24) & 0xff;
-        output[i * 4 + 1] = (H[i] >> 16) & 0xff;
-        output[i * 4 + 2] = (H[i] >> 8) & 0xff;
-        output[i * 4 + 3] = H[i] & 0xff;
-    }
-    
-    free(padded);
-}
-
-void sha256_string(const char *input, uint8_t output[32]) {
-    sha256((const uint8_t*)input, strlen(input), output);
-}
-// AES-256-CTR PRNG IMPLEMENTATION
-
-// AES S-box
-static const uint8_t AES_SBOX[256] = {
-    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
-    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
-    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
-    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
-    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
-    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
-    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
-    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
-    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
-    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
-    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
-};
-
-static const uint8_t AES_RCON[15] = {
-    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a
-};
-
-// AES key expansion for AES-256
-static void aes_expand_key(const uint8_t key[32], uint32_t expanded[60]) {
-    // Copy first 8 words (32 bytes) directly
-    for (int i = 0; i < 8; i++) {
-        expanded[i] = ((uint32_t)key[i*4] << 24) |
-                      ((uint32_t)key[i*4+1] << 16) |
-                      ((uint32_t)key[i*4+2] << 8) |
-                      ((uint32_t)key[i*4+3]);
-    }
-    
-    // Generate remaining words
-    for (int i = 8; i < 60; i++) {
-        uint32_t temp = expanded[i-1];
-        
-        if (i % 8 == 0) {
-            // RotWord, SubWord, Rcon
-            uint32_t rotated = (temp << 8) | (temp >> 24);
-            temp = ((uint32_t)AES_SBOX[(rotated >> 24) & 0xff] << 24) |
-                   ((uint32_t)AES_SBOX[(rotated >> 16) & 0xff] << 16) |
-                   ((uint32_t)AES_SBOX[(rotated >> 8) & 0xff] << 8) |
-                   ((uint32_t)AES_SBOX[rotated & 0xff]);
-            temp ^= ((uint32_t)AES_RCON[i/8 - 1] << 24);
-        } else if (i % 8 == 4) {
-            // SubWord only
-            temp = ((uint32_t)AES_SBOX[(temp >> 24) & 0xff] << 24) |
-                   ((uint32_t)AES_SBOX[(temp >> 16) & 0xff] << 16) |
-                   ((uint32_t)AES_SBOX[(temp >> 8) & 0xff] << 8) |
-                   ((uint32_t)AES_SBOX[temp & 0xff]);
-        }
-        
-        expanded[i] = expanded[i-8] ^ temp;
-    }
-}
-
-// AES-256 block encryption
-static void aes_encrypt_block(const uint8_t input[16], uint8_t output[16], 
-                              const uint32_t expanded_key[60]) {
-    uint8_t state[16];
-    memcpy(state, input, 16);
-    
-    // AddRoundKey (round 0)
-    for (int i = 0; i < 4; i++) {
-        uint32_t word = expanded_key[i];
-        state[i*4] ^= (word >> 24) & 0xff;
-        state[i*4+1] ^= (word >> 16) & 0xff;
-        state[i*4+2] ^= (word >> 8) & 0xff;
-        state[i*4+3] ^= word & 0xff;
-    }
-    
-    // 13 rounds
-    for (int round = 1; round < 14; round++) {
-        uint8_t temp[16];
-        
-        // SubBytes + ShiftRows
-        temp[0] = AES_SBOX[state[0]];  temp[1] = AES_SBOX[state[5]];
-        temp[2] = AES_SBOX[state[10]]; temp[3] = AES_SBOX[state[15]];
-        temp[4] = AES_SBOX[state[4]];  temp[5] = AES_SBOX[state[9]];
-        temp[6] = AES_SBOX[state[14]]; temp[7] = AES_SBOX[state[3]];
-        temp[8] = AES_SBOX[state[8]];  temp[9] = AES_SBOX[state[13]];
-        temp[10] = AES_SBOX[state[2]]; temp[11] = AES_SBOX[state[7]];
-        temp[12] = AES_SBOX[state[12]]; temp[13] = AES_SBOX[state[1]];
-        temp[14] = AES_SBOX[state[6]]; temp[15] = AES_SBOX[state[11]];
-        
-        // MixColumns (skip in last round)
-        if (round < 13) {
-            for (int c = 0; c < 4; c++) {
-                uint8_t a0 = temp[c*4], a1 = temp[c*4+1], a2 = temp[c*4+2], a3 = temp[c*4+3];
-                state[c*4] = (a0 << 1) ^ ((a0 >> 7) * 0x1b) ^ (a1 << 1) ^ ((a1 >> 7) * 0x1b) ^ a1 ^ a2 ^ a3;
-                state[c*4+1] = a0 ^ (a1 << 1) ^ ((a1 >> 7) * 0x1b) ^ (a2 << 1) ^ ((a2 >> 7) * 0x1b) ^ a2 ^ a3;
-                state[c*4+2] = a0 ^ a1 ^ (a2 << 1) ^ ((a2 >> 7) * 0x1b) ^ (a3 << 1) ^ ((a3 >> 7) * 0x1b) ^ a3;
-                state[c*4+3] = (a0 << 1) ^ ((a0 >> 7) * 0x1b) ^ a0 ^ a1 ^ a2 ^ (a3 << 1) ^ ((a3 >> 7) * 0x1b);
-            }
-        } else {
-            memcpy(state, temp, 16);
-        }
-        
-        // AddRoundKey
-        for (int i = 0; i < 4; i++) {
-            uint32_t word = expanded_key[round * 4 + i];
-            state[i*4] ^= (word >> 24) & 0xff;
-            state[i*4+1] ^= (word >> 16) & 0xff;
-            state[i*4+2] ^= (word >> 8) & 0xff;
-            state[i*4+3] ^= word & 0xff;
-        }
-    }
-    
-    memcpy(output, state, 16);
-}
-
-void aes_ctr_init(AES_CTR_PRNG *prng, const uint8_t seed[32]) {
-    memcpy(prng->key, seed, 32);
-    memset(prng->counter, 0, 16);
-    memset(prng->keystream, 0, 16);
-    prng->pos = 16;  // Force generation on first call
-    
-    // Expand key once
-    aes_expand_key(prng->key, prng->expanded_key);
-}
-
-uint64_t aes_ctr_next(AES_CTR_PRNG *prng) {
-    uint64_t result = 0;
-    
-    for (int i = 0; i < 8; i++) {
-        if (prng->pos >= 16) {
-            // Generate new keystream block
-            aes_encrypt_block(prng->counter, prng->keystream, prng->expanded_key);
-            prng->pos = 0;
-            
-            // Increment counter
-            for (int j = 15; j >= 0; j--) {
-                if (++prng->counter[j] != 0) break;
-            }
-        }
-        
-        result |= ((uint64_t)prng->keystream[prng->pos++]) << (i * 8);
-    }
-    
-    return result;
-}
-
-// SHA3-256 PADDING
-
-size_t apply_sha3_padding(const uint8_t *message, size_t msg_len, 
-                          uint8_t *padded, size_t max_padded_len) {
-    const size_t rate_bytes = 136;  // 1088 bits / 8
-    
-    // Calculate padded length
-    size_t padded_len = ((msg_len + 1 + 8) / rate_bytes + 1) * rate_bytes;
-    if (padded_len > max_padded_len) {
-        fprintf(stderr, "Error: Padded length %zu exceeds maximum %zu\n", 
-                padded_len, max_padded_len);
-        return 0;
-    }
-    
-    // Initialize padded array
-    memset(padded, 0, padded_len);
-    memcpy(padded, message, msg_len);
-    
-    // Add domain separator '01' and start of padding '1'
-    // 0x06 = 0000 0110 = bits 01 (domain) + 1 (padding start)
-    padded[msg_len] = 0x06;
-    
-    // Add final '1' at the end (pad10*1 rule)
-    padded[padded_len - 1] |= 0x80;
-    
-    return padded_len;
-}
-// SCHEDULE GENERATION
-
-void generate_schedule_internal(const uint8_t seed[32], KeccakSchedule *schedule) {
-    AES_CTR_PRNG prng;
-    aes_ctr_init(&prng, seed);
-    
-    // Copy seed
-    memcpy(schedule->seed, seed, 32);
-    
-    // Generate 24 rounds
-    for (int r = 0; r < 24; r++) {
-        RoundSchedule *rs = &schedule->rounds[r];
-        
-        // Initialize step order: θ, ρπ, χ, ι
-        rs->step_order[0] = 0;  // THETA
-        rs->step_order[1] = 1;  // RHOPI
-        rs->step_order[2] = 2;  // CHI
-        rs->step_order[3] = 3;  // IOTA
-        
-        // Shuffle: swap θ and ρπ if PRNG output is odd
-        uint64_t shuffle_val = aes_ctr_next(&prng);
-        if ((shuffle_val % 2) == 1) {
-            // Swap THETA and RHOPI
-            int temp = rs->step_order[0];
-            rs->step_order[0] = rs->step_order[1];
-            rs->step_order[1] = temp;
-        }
-        
-        // Generate variants for each step (in order)
-        for (int s = 0; s < 4; s++) {
-            uint64_t variant_val = aes_ctr_next(&prng);
-            rs->variants[s] = (int)(variant_val % 7);
-        }
-    }
-}
-
-void generate_schedule_from_plaintext(const char *plaintext, KeccakSchedule *schedule) {
-    // Concatenate domain separator with plaintext
-    size_t sep_len = strlen(DOMAIN_SEPARATOR_MSG);
-    size_t msg_len = strlen(plaintext);
-    char *combined = (char*)malloc(sep_len + msg_len + 1);
-    strcpy(combined, DOMAIN_SEPARATOR_MSG);
-    strcat(combined, plaintext);
-    
-    // Generate seed = SHA256(domain_separator || plaintext)
-    uint8_t seed[32];
-    sha256_string(combined, seed);
-    
-    schedule->mode = MODE_PLAINTEXT;
-    generate_schedule_internal(seed, schedule);
-    
-    free(combined);
-}
-
-void generate_schedule_from_binary(const uint8_t *data, size_t data_len, KeccakSchedule *schedule) {
-    // Concatenate domain separator with binary data
-    size_t sep_len = strlen(DOMAIN_SEPARATOR_MSG);
-    size_t combined_len = sep_len + data_len;
-    uint8_t *combined = (uint8_t*)malloc(combined_len);
-    
-    memcpy(combined, DOMAIN_SEPARATOR_MSG, sep_len);
-    memcpy(combined + sep_len, data, data_len);
-    
-    // Generate seed = SHA256(domain_separator || data)
-    uint8_t seed[32];
-    sha256(combined, combined_len, seed);
-    
-    schedule->mode = MODE_PLAINTEXT;
-    generate_schedule_internal(seed, schedule);
-    
-    free(combined);
-}
-
-void generate_schedule_from_key(const char *key, KeccakSchedule *schedule) {
-    // Concatenate domain separator with key
-    size_t sep_len = strlen(DOMAIN_SEPARATOR_KEY);
-    size_t key_len = strlen(key);
-    char *combined = (char*)malloc(sep_len + key_len + 1);
-    strcpy(combined, DOMAIN_SEPARATOR_KEY);
-    strcat(combined, key);
-    
-    // Generate seed = SHA256(domain_separator || key)
-    uint8_t seed[32];
-    sha256_string(combined, seed);
-    
-    schedule->mode = MODE_KEY;
-    generate_schedule_internal(seed, schedule);
-    
-    free(combined);
-}
-
-// STATE INITIALIZATION
-
-// Initialize Keccak state from binary message with explicit length
-void init_state_from_message(const uint8_t *message, size_t msg_len, u64 state[25]) {
-    // Initialize all lanes to 0
-    memset(state, 0, 25 * sizeof(u64));
-    
-    // Apply SHA3-256 padding
-    uint8_t padded[1088];  // Maximum one block for SHA3-256
-    size_t padded_len = apply_sha3_padding(message, msg_len, padded, sizeof(padded));
-    
-    if (padded_len == 0) {
-        fprintf(stderr, "Error: Padding failed\n");
-        return;
-    }
-    
-    // XOR padded message with rate portion (first 17 lanes = 136 bytes)
-    for (int i = 0; i < 17; i++) {
-        u64 lane = 0;
-        for (int j = 0; j < 8; j++) {
-            size_t byte_idx = i * 8 + j;
-            if (byte_idx < padded_len) {
-                lane |= ((u64)padded[byte_idx]) << (j * 8);
-            }
-        }
-        state[i] = lane;
-    }
-    
-    // Capacity (lanes 17-24) remain 0
-}
-
-// Initialize Keccak state from plaintext C-string (wrapper for compatibility)
-void init_state_from_plaintext(const char *plaintext, u64 state[25]) {
-    size_t msg_len = strlen(plaintext);
-    init_state_from_message((const uint8_t*)plaintext, msg_len, state);
-}
-
-// PRINTING FUNCTIONS
-
-void print_round_schedule(int round, const RoundSchedule *rs) {
-    const char *step_names[] = {"THETA", "RHOPI", "CHI", "IOTA"};
-    
-    printf("Round %2d: ", round);
-    for (int i = 0; i < 4; i++) {
-        int step = rs->step_order[i];
-        printf("%s-V%d", step_names[step], rs->variants[i]);
-        if (i < 3) printf(" -> ");
-    }
-    printf("\n");
-}
-
-void print_schedule(const KeccakSchedule *schedule) {
-    printf("\n=== Keccak Variant Schedule ===\n");
-    printf("Mode: %s\n", schedule->mode == MODE_PLAINTEXT ? "PLAINTEXT" : "KEY");
-    printf("Seed (SHA-256): ");
-    for (int i = 0; i < 32; i++) {
-        printf("%02x", schedule->seed[i]);
-    }
-    printf("\n\n");
-    
-    for (int r = 0; r < 24; r++) {
-        print_round_schedule(r, &schedule->rounds[r]);
-    }
-    
-    printf("===============================\n\n");
-}
+#include "seed_generation.h"
+#include "cpu_dispatch.h"
+#include "keccak_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+// SHA-256 IMPLEMENTATION
+
+// SHA-256 constants
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define SIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define GAMMA0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+// Process one 64-byte block into the chaining value
+static void sha256_compress_block(uint32_t H[8], const uint8_t block[64]) {
+    uint32_t W[64];
+    
+    // Prepare message schedule
+    for (int t = 0; t < 16; t++) {
+        W[t] = ((uint32_t)block[t * 4] << 24) |
+               ((uint32_t)block[t * 4 + 1] << 16) |
+               ((uint32_t)block[t * 4 + 2] << 8) |
+               ((uint32_t)block[t * 4 + 3]);
+    }
+    for (int t = 16; t < 64; t++) {
+        W[t] = GAMMA1(W[t-2]) + W[t-7] + GAMMA0(W[t-15]) + W[t-16];
+    }
+    
+    // Initialize working variables
+    uint32_t a = H[0], b = H[1], c = H[2], d = H[3];
+    uint32_t e = H[4], f = H[5], g = H[6], h = H[7];
+    
+    // Main loop
+    for (int t = 0; t < 64; t++) {
+        uint32_t T1 = h + SIG1(e) + CH(e, f, g) + SHA256_K[t] + W[t];
+        uint32_t T2 = SIG0(a) + MAJ(a, b, c);
+        h = g; g = f; f = e; e = d + T1;
+        d = c; c = b; b = a; a = T1 + T2;
+    }
+    
+    // Update hash values
+    H[0] += a; H[1] += b; H[2] += c; H[3] += d;
+    H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+}
+
+// SHA-NI path: the SHA extensions run two rounds per sha256rnds2 and the
+// message schedule in sha256msg1/msg2. Compiled for the target with a
+// function attribute and selected at run time, so the portable build keeps
+// working on CPUs without it.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_HAVE_SHANI 1
+
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani(uint32_t H[8], const uint8_t *data, size_t blocks) {
+    const __m128i BSWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i STATE0, STATE1, TMP, M[4];
+
+    // H is A..H; the instructions want ABEF and CDGH
+    TMP = _mm_loadu_si128((const __m128i*)&H[0]);
+    STATE1 = _mm_loadu_si128((const __m128i*)&H[4]);
+    TMP = _mm_shuffle_epi32(TMP, 0xB1);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0x1B);
+    STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        __m128i ABEF_SAVE = STATE0;
+        __m128i CDGH_SAVE = STATE1;
+
+        for (int i = 0; i < 4; i++) {
+            M[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), BSWAP);
+        }
+
+        // Four rounds per group; M[g % 4] holds W[4g..4g+3]
+#pragma GCC unroll 16
+        for (int g = 0; g < 16; g++) {
+            __m128i MSG = _mm_add_epi32(M[g % 4], _mm_loadu_si128((const __m128i*)&SHA256_K[4 * g]));
+            STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+            STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, _mm_shuffle_epi32(MSG, 0x0E));
+
+            if (g >= 3 && g < 15) {
+                __m128i *next = &M[(g + 1) % 4];
+                *next = _mm_add_epi32(*next, _mm_alignr_epi8(M[g % 4], M[(g + 3) % 4], 4));
+                *next = _mm_sha256msg2_epu32(*next, M[g % 4]);
+            }
+            if (g >= 1 && g <= 12) {
+                M[(g + 3) % 4] = _mm_sha256msg1_epu32(M[(g + 3) % 4], M[g % 4]);
+            }
+        }
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    }
+
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);
+    STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0);
+    STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);
+    _mm_storeu_si128((__m128i*)&H[0], STATE0);
+    _mm_storeu_si128((__m128i*)&H[4], STATE1);
+}
+#endif
+
+int sha256_has_shani(void) {
+#ifdef SHA256_HAVE_SHANI
+    return (cpu_features() & CPU_SHANI) != 0;
+#else
+    return 0;
+#endif
+}
+
+// Process consecutive 64-byte blocks, on SHA-NI when the CPU has it
+static void sha256_compress(uint32_t H[8], const uint8_t *data, size_t blocks) {
+    KECCAK_STATS_ONLY(size_t total = blocks;)
+    KECCAK_STATS_START(start);
+
+#ifdef SHA256_HAVE_SHANI
+    if (sha256_has_shani()) {
+        sha256_compress_shani(H, data, blocks);
+        KECCAK_STATS_SHA256(total, start);
+        return;
+    }
+#endif
+    for (; blocks > 0; blocks--, data += 64) {
+        sha256_compress_block(H, data);
+    }
+    KECCAK_STATS_SHA256(total, start);
+}
+
+#define SHA256_IV { \
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, \
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 \
+}
+
+// Domain separators absorbed once at compile time. All are shorter than a
+// block, so the midstate is the IV with the separator already buffered.
+const SHA256_CTX SHA256_MIDSTATE_MSG = {
+    SHA256_IV, DOMAIN_SEPARATOR_MSG, sizeof(DOMAIN_SEPARATOR_MSG) - 1, sizeof(DOMAIN_SEPARATOR_MSG) - 1
+};
+const SHA256_CTX SHA256_MIDSTATE_KEY = {
+    SHA256_IV, DOMAIN_SEPARATOR_KEY, sizeof(DOMAIN_SEPARATOR_KEY) - 1, sizeof(DOMAIN_SEPARATOR_KEY) - 1
+};
+const SHA256_CTX SHA256_MIDSTATE_NONCE = {
+    SHA256_IV, DOMAIN_SEPARATOR_NONCE, sizeof(DOMAIN_SEPARATOR_NONCE) - 1,
+    sizeof(DOMAIN_SEPARATOR_NONCE) - 1
+};
+
+void sha256_init(SHA256_CTX *ctx) {
+    static const uint32_t IV[8] = SHA256_IV;
+    memcpy(ctx->H, IV, sizeof(IV));
+    ctx->block_len = 0;
+    ctx->total_len = 0;
+}
+
+void sha256_update(SHA256_CTX *ctx, const uint8_t *input, size_t len) {
+    ctx->total_len += len;
+    
+    // Complete a partially buffered block first
+    if (ctx->block_len > 0) {
+        size_t take = 64 - ctx->block_len;
+        if (take > len) take = len;
+        memcpy(ctx->block + ctx->block_len, input, take);
+        ctx->block_len += take;
+        input += take;
+        len -= take;
+        if (ctx->block_len < 64) return;
+        sha256_compress(ctx->H, ctx->block, 1);
+        ctx->block_len = 0;
+    }
+    
+    // Whole blocks are compressed straight from the input
+    sha256_compress(ctx->H, input, len / 64);
+    input += len - len % 64;
+    len %= 64;
+    
+    memcpy(ctx->block, input, len);
+    ctx->block_len = len;
+}
+
+void sha256_final(SHA256_CTX *ctx, uint8_t output[32]) {
+    uint64_t bit_len = ctx->total_len * 8;
+    
+    // Need: message + 0x80 + padding_zeros such that total ≡ 56 (mod 64), then + 8 bytes for length
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > 56) {
+        memset(ctx->block + ctx->block_len, 0, 64 - ctx->block_len);
+        sha256_compress(ctx->H, ctx->block, 1);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, 56 - ctx->block_len);
+    
+    // Append length in big-endian
+    for (int i = 0; i < 8; i++) {
+        ctx->block[56 + i] = (bit_len >> (56 - i * 8)) & 0xff;
+    }
+    sha256_compress(ctx->H, ctx->block, 1);
+    
+    // Convert to byte array
+    for (int i = 0; i < 8; i++) {
+        output[i * 4] = (ctx->H[i] >> 24) & 0xff;
+        output[i * 4 + 1] = (ctx->H[i] >> 16) & 0xff;
+        output[i * 4 + 2] = (ctx->H[i] >> 8) & 0xff;
+        output[i * 4 + 3] = ctx->H[i] & 0xff;
+    }
+}
+
+void sha256(const uint8_t *input, size_t len, uint8_t output[32]) {
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, input, len);
+    sha256_final(&ctx, output);
+}
+
+void sha256_string(const char *input, uint8_t output[32]) {
+    sha256((const uint8_t*)input, strlen(input), output);
+}
+// AES-256-CTR PRNG IMPLEMENTATION
+
+static const uint8_t AES_RCON[15] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a
+};
+
+// The cipher runs 13 rounds (12 with MixColumns, then a final one without)
+// using round keys 0-13 of the AES-256 key schedule. Every backend below
+// reproduces exactly that, so the keystream does not depend on the CPU.
+#define AES_ROUNDS 13
+
+// BITSLICED AES
+
+// Constant-time portable backend: no table lookups indexed by secret data.
+// Four blocks are processed at once in eight 64-bit slices; slice i holds
+// bit i of every byte, at bit position block * 16 + byte index.
+
+// AES S-box as a Boolean circuit (Boyar-Peralta), applied to 64 bytes at once
+static void aes_sbox_bitsliced(uint64_t q[8]) {
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+    uint64_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+    x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+    // Top linear transformation
+    y14 = x3 ^ x5;   y13 = x0 ^ x6;   y9 = x0 ^ x3;    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;    y1 = t0 ^ x7;    y4 = y1 ^ x3;    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;    y5 = y1 ^ x6;    y3 = y5 ^ y8;    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;   y20 = t1 ^ x1;   y6 = y15 ^ x7;   y10 = y15 ^ t0;
+    y11 = y20 ^ y9;  y7 = x7 ^ y11;   y17 = y10 ^ y11; y19 = y10 ^ y8;
+    y16 = t0 ^ y11;  y21 = y13 ^ y16; y18 = x0 ^ y16;
+
+    // Non-linear section (GF(2^4) inversion)
+    t2 = y12 & y15;  t3 = y3 & y6;    t4 = t3 ^ t2;    t5 = y4 & x7;
+    t6 = t5 ^ t2;    t7 = y13 & y16;  t8 = y5 & y1;    t9 = t8 ^ t7;
+    t10 = y2 & y7;   t11 = t10 ^ t7;  t12 = y9 & y11;  t13 = y14 & y17;
+    t14 = t13 ^ t12; t15 = y8 & y10;  t16 = t15 ^ t12; t17 = t4 ^ t14;
+    t18 = t6 ^ t16;  t19 = t9 ^ t14;  t20 = t11 ^ t16; t21 = t17 ^ y20;
+    t22 = t18 ^ y19; t23 = t19 ^ y21; t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22; t26 = t21 & t23; t27 = t24 ^ t26; t28 = t25 & t27;
+    t29 = t28 ^ t22; t30 = t23 ^ t24; t31 = t22 ^ t26; t32 = t31 & t30;
+    t33 = t32 ^ t24; t34 = t23 ^ t33; t35 = t27 ^ t33; t36 = t24 & t35;
+    t37 = t36 ^ t34; t38 = t27 ^ t36; t39 = t29 & t38; t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37; t42 = t29 ^ t33; t43 = t29 ^ t40; t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;  z1 = t37 & y6;   z2 = t33 & x7;   z3 = t43 & y16;
+    z4 = t40 & y1;   z5 = t29 & y7;   z6 = t42 & y11;  z7 = t45 & y17;
+    z8 = t41 & y10;  z9 = t44 & y12;  z10 = t37 & y3;  z11 = t33 & y4;
+    z12 = t43 & y13; z13 = t40 & y5;  z14 = t29 & y2;  z15 = t42 & y9;
+    z16 = t45 & y14; z17 = t41 & y8;
+
+    // Bottom linear transformation
+    t46 = z15 ^ z16; t47 = z10 ^ z11; t48 = z5 ^ z13;  t49 = z9 ^ z10;
+    t50 = z2 ^ z12;  t51 = z2 ^ z5;   t52 = z7 ^ z8;   t53 = z0 ^ z3;
+    t54 = z6 ^ z7;   t55 = z16 ^ z17; t56 = z12 ^ t48; t57 = t50 ^ t53;
+    t58 = z4 ^ t46;  t59 = z3 ^ t54;  t60 = t46 ^ t57; t61 = z14 ^ t57;
+    t62 = t52 ^ t58; t63 = t49 ^ t58; t64 = z4 ^ t59;  t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;  s6 = t56 ^ ~t62; s7 = t48 ^ ~t60; t67 = t64 ^ t65;
+    s3 = t53 ^ t66;  s4 = t51 ^ t66;  s5 = t47 ^ t65;  s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+// Byte index within a block is column * 4 + row, as in the AES state
+#define BS_REP(x) ((uint64_t)(x) * 0x0001000100010001ULL)
+
+// ShiftRows: row r of column c takes row r of column (c + r) % 4
+static inline uint64_t bs_shift_rows(uint64_t x) {
+    return (x & BS_REP(0x1111)) |
+           ((x & BS_REP(0x2220)) >> 4)  | ((x & BS_REP(0x0002)) << 12) |
+           ((x & BS_REP(0x4400)) >> 8)  | ((x & BS_REP(0x0044)) << 8)  |
+           ((x & BS_REP(0x8000)) >> 12) | ((x & BS_REP(0x0888)) << 4);
+}
+
+// Row r of each column takes row (r + k) % 4 of the same column
+static inline uint64_t bs_rotate_rows(uint64_t x, int k) {
+    static const uint64_t LOW[4] = {
+        0, BS_REP(0x7777), BS_REP(0x3333), BS_REP(0x1111)
+    };
+    return ((x >> k) & LOW[k]) | ((x << (4 - k)) & ~LOW[k]);
+}
+
+// MixColumns: out[r] = 2*a[r] ^ 3*a[r+1] ^ a[r+2] ^ a[r+3]
+static void bs_mix_columns(uint64_t q[8]) {
+    uint64_t r1[8], d[8];
+
+    for (int i = 0; i < 8; i++) {
+        r1[i] = bs_rotate_rows(q[i], 1);
+        d[i] = q[i] ^ r1[i];
+        q[i] = r1[i] ^ bs_rotate_rows(q[i], 2) ^ bs_rotate_rows(q[i], 3);
+    }
+
+    // xtime(d): multiply by x modulo x^8 + x^4 + x^3 + x + 1
+    q[0] ^= d[7];
+    q[1] ^= d[0] ^ d[7];
+    q[2] ^= d[1];
+    q[3] ^= d[2] ^ d[7];
+    q[4] ^= d[3] ^ d[7];
+    q[5] ^= d[4];
+    q[6] ^= d[5];
+    q[7] ^= d[6];
+}
+
+// Spread one 16-byte block (or round key) into the slices at block position
+static void bs_load(uint64_t q[8], const uint8_t in[16], int block) {
+    for (int p = 0; p < 16; p++) {
+        for (int i = 0; i < 8; i++) {
+            q[i] |= (uint64_t)((in[p] >> i) & 1) << (block * 16 + p);
+        }
+    }
+}
+
+static void bs_store(const uint64_t q[8], uint8_t out[16], int block) {
+    for (int p = 0; p < 16; p++) {
+        uint8_t b = 0;
+        for (int i = 0; i < 8; i++) {
+            b |= (uint8_t)(((q[i] >> (block * 16 + p)) & 1) << i);
+        }
+        out[p] = b;
+    }
+}
+
+// Round key bytes in state order: byte 4i + j is byte j (MSB first) of word i
+static void aes_round_key_bytes(const uint32_t expanded_key[60], int round, uint8_t rk[16]) {
+    for (int i = 0; i < 4; i++) {
+        uint32_t word = expanded_key[round * 4 + i];
+        rk[i*4] = (word >> 24) & 0xff;
+        rk[i*4+1] = (word >> 16) & 0xff;
+        rk[i*4+2] = (word >> 8) & 0xff;
+        rk[i*4+3] = word & 0xff;
+    }
+}
+
+// AES S-box on the four bytes of a word, through the same circuit
+static uint32_t aes_sub_word(uint32_t w) {
+    uint64_t q[8];
+
+    for (int i = 0; i < 8; i++) {
+        q[i] = 0;
+        for (int j = 0; j < 4; j++) {
+            q[i] |= (uint64_t)((w >> (j * 8 + i)) & 1) << j;
+        }
+    }
+    aes_sbox_bitsliced(q);
+
+    uint32_t out = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            out |= (uint32_t)((q[i] >> j) & 1) << (j * 8 + i);
+        }
+    }
+    return out;
+}
+
+// AES key expansion for AES-256
+static void aes_expand_key(const uint8_t key[32], uint32_t expanded[60]) {
+    // Copy first 8 words (32 bytes) directly
+    for (int i = 0; i < 8; i++) {
+        expanded[i] = ((uint32_t)key[i*4] << 24) |
+                      ((uint32_t)key[i*4+1] << 16) |
+                      ((uint32_t)key[i*4+2] << 8) |
+                      ((uint32_t)key[i*4+3]);
+    }
+    
+    // Generate remaining words
+    for (int i = 8; i < 60; i++) {
+        uint32_t temp = expanded[i-1];
+        
+        if (i % 8 == 0) {
+            // RotWord, SubWord, Rcon
+            uint32_t rotated = (temp << 8) | (temp >> 24);
+            temp = aes_sub_word(rotated);
+            temp ^= ((uint32_t)AES_RCON[i/8 - 1] << 24);
+        } else if (i % 8 == 4) {
+            // SubWord only
+            temp = aes_sub_word(temp);
+        }
+        
+        expanded[i] = expanded[i-8] ^ temp;
+    }
+}
+
+// Increment the 128-bit big-endian counter block
+static inline void aes_ctr_increment(uint8_t counter[16]) {
+    for (int j = 15; j >= 0; j--) {
+        if (++counter[j] != 0) break;
+    }
+}
+
+// Encrypt the next `blocks` counter values into out, four at a time
+static void aes_ctr_blocks_bitsliced(const uint32_t expanded_key[60], uint8_t counter[16],
+                                     uint8_t *out, size_t blocks) {
+    uint64_t rk[AES_ROUNDS + 1][8];
+
+    // Round keys are the same for all four block positions
+    for (int r = 0; r <= AES_ROUNDS; r++) {
+        uint8_t bytes[16];
+        aes_round_key_bytes(expanded_key, r, bytes);
+        memset(rk[r], 0, sizeof(rk[r]));
+        bs_load(rk[r], bytes, 0);
+        for (int i = 0; i < 8; i++) {
+            rk[r][i] = BS_REP(rk[r][i]);
+        }
+    }
+
+    while (blocks > 0) {
+        int count = blocks < 4 ? (int)blocks : 4;
+        uint64_t q[8] = {0};
+
+        for (int b = 0; b < count; b++) {
+            bs_load(q, counter, b);
+            aes_ctr_increment(counter);
+        }
+
+        for (int i = 0; i < 8; i++) q[i] ^= rk[0][i];
+        for (int round = 1; round <= AES_ROUNDS; round++) {
+            aes_sbox_bitsliced(q);
+            for (int i = 0; i < 8; i++) q[i] = bs_shift_rows(q[i]);
+            if (round < AES_ROUNDS) {
+                bs_mix_columns(q);
+            }
+            for (int i = 0; i < 8; i++) q[i] ^= rk[round][i];
+        }
+
+        for (int b = 0; b < count; b++) {
+            bs_store(q, out + b * 16, b);
+        }
+        out += count * 16;
+        blocks -= count;
+    }
+}
+
+// AES-NI / VAES
+
+// Counter mode has no chaining, so the hardware paths keep 8 (AES-NI) or
+// 16 (VAES, four blocks per register) independent blocks in flight to hide
+// the aesenc latency. Compiled for the target with function attributes and
+// selected at run time.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_HAVE_AESNI 1
+
+static inline uint64_t load64_be(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// Lay out the next n counter blocks as 64-bit words in memory order, ready
+// for vector loads (the counter is a 128-bit big-endian integer)
+static inline void aes_ctr_expand(const uint8_t counter[16], uint64_t *out, int n) {
+    uint64_t hi = load64_be(counter);
+    uint64_t lo = load64_be(counter + 8);
+
+    for (int b = 0; b < n; b++) {
+        out[2 * b] = __builtin_bswap64(hi);
+        out[2 * b + 1] = __builtin_bswap64(lo);
+        if (++lo == 0) hi++;
+    }
+}
+
+static inline void aes_ctr_advance(uint8_t counter[16], size_t n) {
+    for (size_t b = 0; b < n; b++) {
+        aes_ctr_increment(counter);
+    }
+}
+
+__attribute__((target("aes")))
+static void aes_ctr_blocks_aesni(const uint32_t expanded_key[60], uint8_t counter[16],
+                                 uint8_t *out, size_t blocks) {
+    __m128i rk[AES_ROUNDS + 1];
+
+    for (int r = 0; r <= AES_ROUNDS; r++) {
+        uint8_t bytes[16];
+        aes_round_key_bytes(expanded_key, r, bytes);
+        rk[r] = _mm_loadu_si128((const __m128i*)bytes);
+    }
+
+    while (blocks > 0) {
+        size_t count = blocks < 8 ? blocks : 8;
+        uint64_t ctr[16];
+        __m128i x[8];
+
+        // A short final group still encrypts 8 counters but only advances
+        // the counter and writes output for the blocks requested
+        aes_ctr_expand(counter, ctr, 8);
+        aes_ctr_advance(counter, count);
+
+        for (int b = 0; b < 8; b++) {
+            x[b] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&ctr[2 * b]), rk[0]);
+        }
+        for (int round = 1; round < AES_ROUNDS; round++) {
+            for (int b = 0; b < 8; b++) {
+                x[b] = _mm_aesenc_si128(x[b], rk[round]);
+            }
+        }
+        for (int b = 0; b < 8; b++) {
+            x[b] = _mm_aesenclast_si128(x[b], rk[AES_ROUNDS]);
+        }
+
+        for (size_t b = 0; b < count; b++) {
+            _mm_storeu_si128((__m128i*)(out + b * 16), x[b]);
+        }
+        out += count * 16;
+        blocks -= count;
+    }
+}
+
+__attribute__((target("vaes,avx512f")))
+static void aes_ctr_blocks_vaes(const uint32_t expanded_key[60], uint8_t counter[16],
+                                uint8_t *out, size_t blocks) {
+    __m512i rk[AES_ROUNDS + 1];
+
+    for (int r = 0; r <= AES_ROUNDS; r++) {
+        uint8_t bytes[16];
+        aes_round_key_bytes(expanded_key, r, bytes);
+        rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)bytes));
+    }
+
+    for (; blocks >= 16; blocks -= 16, out += 256) {
+        uint64_t ctr[32];
+        __m512i x[4];
+
+        aes_ctr_expand(counter, ctr, 16);
+        aes_ctr_advance(counter, 16);
+
+        for (int v = 0; v < 4; v++) {
+            x[v] = _mm512_xor_si512(_mm512_loadu_si512(&ctr[v * 8]), rk[0]);
+        }
+        for (int round = 1; round < AES_ROUNDS; round++) {
+            for (int v = 0; v < 4; v++) {
+                x[v] = _mm512_aesenc_epi128(x[v], rk[round]);
+            }
+        }
+        for (int v = 0; v < 4; v++) {
+            x[v] = _mm512_aesenclast_epi128(x[v], rk[AES_ROUNDS]);
+            _mm512_storeu_si512(out + v * 64, x[v]);
+        }
+    }
+
+    if (blocks > 0) {
+        aes_ctr_blocks_aesni(expanded_key, counter, out, blocks);
+    }
+}
+#endif
+
+// Encrypt the next `blocks` counter values into out on the best backend
+static void aes_ctr_blocks(const uint32_t expanded_key[60], uint8_t counter[16],
+                           uint8_t *out, size_t blocks) {
+#ifdef AES_HAVE_AESNI
+    unsigned features = cpu_features();
+
+    // The VAES path finishes short tails on AES-NI
+    if ((features & CPU_VAES) && (features & CPU_AESNI)) {
+        aes_ctr_blocks_vaes(expanded_key, counter, out, blocks);
+        return;
+    }
+    if (features & CPU_AESNI) {
+        aes_ctr_blocks_aesni(expanded_key, counter, out, blocks);
+        return;
+    }
+#endif
+    aes_ctr_blocks_bitsliced(expanded_key, counter, out, blocks);
+}
+
+void aes_ctr_init(AES_CTR_PRNG *prng, const uint8_t seed[32]) {
+    memcpy(prng->key, seed, 32);
+    memset(prng->counter, 0, 16);
+    memset(prng->keystream, 0, 16);
+    prng->pos = 16;  // Force generation on first call
+    
+    // Expand key once
+    aes_expand_key(prng->key, prng->expanded_key);
+}
+
+void aes_ctr_fill(AES_CTR_PRNG *prng, uint8_t *out, size_t len) {
+    // Bytes left over in the buffered block
+    while (len > 0 && prng->pos < 16) {
+        *out++ = prng->keystream[prng->pos++];
+        len--;
+    }
+    
+    // Whole blocks go straight to the output
+    size_t blocks = len / 16;
+    aes_ctr_blocks(prng->expanded_key, prng->counter, out, blocks);
+    out += blocks * 16;
+    len %= 16;
+    
+    // Partial block: buffer it for the next call
+    if (len > 0) {
+        aes_ctr_blocks(prng->expanded_key, prng->counter, prng->keystream, 1);
+        prng->pos = 0;
+        while (len > 0) {
+            *out++ = prng->keystream[prng->pos++];
+            len--;
+        }
+    }
+}
+
+static inline uint64_t load64_le(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v |= (uint64_t)p[i] << (i * 8);
+    }
+    return v;
+}
+
+uint64_t aes_ctr_next(AES_CTR_PRNG *prng) {
+    uint8_t bytes[8];
+    aes_ctr_fill(prng, bytes, 8);
+    return load64_le(bytes);
+}
+
+// SHA3-256 PADDING
+
+size_t apply_sha3_padding(const uint8_t *message, size_t msg_len, 
+                          uint8_t *padded, size_t max_padded_len) {
+    const size_t rate_bytes = 136;  // 1088 bits / 8
+    
+    // Calculate padded length
+    size_t padded_len = ((msg_len + 1 + 8) / rate_bytes + 1) * rate_bytes;
+    if (padded_len > max_padded_len) {
+        fprintf(stderr, "Error: Padded length %zu exceeds maximum %zu\n", 
+                padded_len, max_padded_len);
+        return 0;
+    }
+    
+    // Initialize padded array
+    memset(padded, 0, padded_len);
+    memcpy(padded, message, msg_len);
+    
+    // Add domain separator '01' and start of padding '1'
+    // 0x06 = 0000 0110 = bits 01 (domain) + 1 (padding start)
+    padded[msg_len] = 0x06;
+    
+    // Add final '1' at the end (pad10*1 rule)
+    padded[padded_len - 1] |= 0x80;
+    
+    return padded_len;
+}
+// SCHEDULE GENERATION
+
+void generate_schedule_internal(const uint8_t seed[32], KeccakSchedule *schedule) {
+    AES_CTR_PRNG prng;
+    KECCAK_STATS_START(start);
+    aes_ctr_init(&prng, seed);
+    
+    // One shuffle value and four variant values per round, all drawn up
+    // front in a single keystream call (60 AES blocks)
+    uint8_t stream[24 * 5 * 8];
+    const uint8_t *draw = stream;
+    aes_ctr_fill(&prng, stream, sizeof(stream));
+    KECCAK_STATS_SCHEDULE(start);
+    
+    // Copy seed
+    memcpy(schedule->seed, seed, 32);
+    
+    // Generate 24 rounds
+    schedule->num_rounds = KECCAK_ROUNDS_FULL;
+    for (int r = 0; r < KECCAK_ROUNDS_FULL; r++) {
+        RoundSchedule *rs = &schedule->rounds[r];
+        
+        // Initialize step order: θ, ρπ, χ, ι
+        rs->step_order[0] = 0;  // THETA
+        rs->step_order[1] = 1;  // RHOPI
+        rs->step_order[2] = 2;  // CHI
+        rs->step_order[3] = 3;  // IOTA
+        
+        // Shuffle: swap θ and ρπ if PRNG output is odd
+        uint64_t shuffle_val = load64_le(draw);
+        draw += 8;
+        if ((shuffle_val % 2) == 1) {
+            // Swap THETA and RHOPI
+            int temp = rs->step_order[0];
+            rs->step_order[0] = rs->step_order[1];
+            rs->step_order[1] = temp;
+        }
+        
+        // Generate variants for each step (in order)
+        for (int s = 0; s < 4; s++) {
+            uint64_t variant_val = load64_le(draw);
+            draw += 8;
+            rs->variants[s] = (int)(variant_val % 7);
+        }
+    }
+}
+
+void generate_schedule_from_sha256(SHA256_CTX *ctx, ScheduleMode mode, KeccakSchedule *schedule) {
+    uint8_t seed[32];
+    sha256_final(ctx, seed);
+    
+    schedule->mode = mode;
+    generate_schedule_internal(seed, schedule);
+}
+
+void generate_schedule_from_plaintext(const char *plaintext, KeccakSchedule *schedule) {
+    generate_schedule_from_binary((const uint8_t*)plaintext, strlen(plaintext), schedule);
+}
+
+void generate_schedule_from_binary(const uint8_t *data, size_t data_len, KeccakSchedule *schedule) {
+    // Generate seed = SHA256(domain_separator || data), separator pre-absorbed
+    SHA256_CTX ctx = SHA256_MIDSTATE_MSG;
+    sha256_update(&ctx, data, data_len);
+    generate_schedule_from_sha256(&ctx, MODE_PLAINTEXT, schedule);
+}
+
+void generate_schedule_from_key(const char *key, KeccakSchedule *schedule) {
+    // Generate seed = SHA256(domain_separator || key), separator pre-absorbed
+    SHA256_CTX ctx = SHA256_MIDSTATE_KEY;
+    sha256_update(&ctx, (const uint8_t*)key, strlen(key));
+    generate_schedule_from_sha256(&ctx, MODE_KEY, schedule);
+}
+
+void sha256_start_key_nonce(SHA256_CTX *ctx, const char *key) {
+    size_t key_len = strlen(key);
+    uint8_t encoded_len[8];
+
+    // The key length keeps the key / nonce boundary unambiguous
+    for (int j = 0; j < 8; j++) {
+        encoded_len[j] = (uint8_t)((uint64_t)key_len >> (8 * j));
+    }
+    *ctx = SHA256_MIDSTATE_NONCE;
+    sha256_update(ctx, encoded_len, sizeof(encoded_len));
+    sha256_update(ctx, (const uint8_t*)key, key_len);
+}
+
+void generate_schedule_from_key_nonce(const char *key, const uint8_t *nonce, size_t nonce_len,
+                                      KeccakSchedule *schedule) {
+    SHA256_CTX ctx;
+
+    sha256_start_key_nonce(&ctx, key);
+    sha256_update(&ctx, nonce, nonce_len);
+    generate_schedule_from_sha256(&ctx, MODE_KEY_NONCE, schedule);
+}
+
+int schedule_set_rounds(KeccakSchedule *schedule, int num_rounds) {
+    if (num_rounds < 1 || num_rounds > schedule->num_rounds) {
+        return -1;
+    }
+    schedule->num_rounds = num_rounds;
+    return 0;
+}
+
+// STATE INITIALIZATION
+
+// Initialize Keccak state from binary message with explicit length
+void init_state_from_message(const uint8_t *message, size_t msg_len, u64 state[25]) {
+    // Initialize all lanes to 0
+    memset(state, 0, 25 * sizeof(u64));
+    
+    // Apply SHA3-256 padding
+    uint8_t padded[1088];  // Maximum one block for SHA3-256
+    size_t padded_len = apply_sha3_padding(message, msg_len, padded, sizeof(padded));
+    
+    if (padded_len == 0) {
+        fprintf(stderr, "Error: Padding failed\n");
+        return;
+    }
+    
+    // XOR padded message with rate portion (first 17 lanes = 136 bytes)
+    for (int i = 0; i < 17; i++) {
+        u64 lane = 0;
+        for (int j = 0; j < 8; j++) {
+            size_t byte_idx = i * 8 + j;
+            if (byte_idx < padded_len) {
+                lane |= ((u64)padded[byte_idx]) << (j * 8);
+            }
+        }
+        state[i] = lane;
+    }
+    
+    // Capacity (lanes 17-24) remain 0
+}
+
+// Initialize Keccak state from plaintext C-string (wrapper for compatibility)
+void init_state_from_plaintext(const char *plaintext, u64 state[25]) {
+    size_t msg_len = strlen(plaintext);
+    init_state_from_message((const uint8_t*)plaintext, msg_len, state);
+}
+
+// PRINTING FUNCTIONS
+
+void print_round_schedule(int round, const RoundSchedule *rs) {
+    const char *step_names[] = {"THETA", "RHOPI", "CHI", "IOTA"};
+    
+    printf("Round %2d: ", round);
+    for (int i = 0; i < 4; i++) {
+        int step = rs->step_order[i];
+        printf("%s-V%d", step_names[step], rs->variants[i]);
+        if (i < 3) printf(" -> ");
+    }
+    printf("\n");
+}
+
+void print_schedule(const KeccakSchedule *schedule) {
+    printf("\n=== Keccak Variant Schedule ===\n");
+    printf("Mode: %s\n", schedule->mode == MODE_PLAINTEXT ? "PLAINTEXT" :
+                          schedule->mode == MODE_KEY ? "KEY" : "KEY_NONCE");
+    printf("Rounds: %d\n", schedule->num_rounds);
+    printf("Seed (SHA-256): ");
+    for (int i = 0; i < 32; i++) {
+        printf("%02x", schedule->seed[i]);
+    }
+    printf("\n\n");
+    
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        print_round_schedule(r, &schedule->rounds[r]);
+    }
+    
+    printf("===============================\n\n");
+}
+
+// Print the schedule as a ROUND(round, order, theta, rhopi, chi, iota)
+// X-macro for KECCAK_DEFINE_STATIC_PERMUTATION (keccak_static.h). The round
+// field is the position in the full permutation (the iota constant index).
+void print_schedule_static(const KeccakSchedule *schedule, const char *name) {
+    int first = KECCAK_ROUNDS_FULL - schedule->num_rounds;
+
+    printf("#define %s(ROUND) \\\n", name);
+    for (int r = 0; r < schedule->num_rounds; r++) {
+        const RoundSchedule *rs = &schedule->rounds[r];
+        int variant[4];
+        for (int i = 0; i < 4; i++) {
+            variant[rs->step_order[i]] = rs->variants[i];
+        }
+        printf("    ROUND(%2d, %d, %d, %d, %d, %d)%s\n", first + r, rs->step_order[0] == 0 ? 0 : 1,
+               variant[0], variant[1], variant[2], variant[3],
+               r < schedule->num_rounds - 1 ? " \\" : "");
+    }
+}
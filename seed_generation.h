@@ -1,80 +1,155 @@
-#ifndef SEED_GENERATION_H
-#define SEED_GENERATION_H
-
-#include <stdint.h>
-
-typedef uint64_t u64;
-
-// Domain separators for seed generation
-#define DOMAIN_SEPARATOR_MSG "KECCAK_VARIANT_MSG_PSJ"
-#define DOMAIN_SEPARATOR_KEY "KECCAK_VARIANT_KEY_PSJ"
-
-// Schedule mode
-typedef enum {
-    MODE_PLAINTEXT,      // Schedule derived from plaintext
-    MODE_KEY             // Schedule derived from key
-} ScheduleMode;
-
-// Variant schedule for one round (4 steps)
-typedef struct {
-    int step_order[4];   // Order of steps: 0=THETA, 1=RHOPI, 2=CHI, 3=IOTA
-    int variants[4];     // Variant number (0-6) for each step
-} RoundSchedule;
-
-// Complete schedule for all 24 rounds
-typedef struct {
-    RoundSchedule rounds[24];
-    ScheduleMode mode;
-    uint8_t seed[32];    // SHA-256 seed used
-} KeccakSchedule;
-
-// AES-256-CTR PRNG state
-typedef struct {
-    uint8_t key[32];
-    uint8_t counter[16];
-    uint8_t keystream[16];
-    int pos;
-    uint32_t expanded_key[60];  // Expanded key for AES-256 (14 rounds)
-} AES_CTR_PRNG;
-
-// SHA-256 hash function
-void sha256(const uint8_t *input, size_t len, uint8_t output[32]);
-
-// SHA-256 with string input
-void sha256_string(const char *input, uint8_t output[32]);
-
-// Initialize AES-256-CTR PRNG with seed
-void aes_ctr_init(AES_CTR_PRNG *prng, const uint8_t seed[32]);
-
-// Get next 64-bit random value
-uint64_t aes_ctr_next(AES_CTR_PRNG *prng);
-
-// Generate schedule from seed (internal, exposed for testing)
-void generate_schedule_internal(const uint8_t seed[32], KeccakSchedule *schedule);
-
-// Generate complete Keccak schedule from plaintext (string)
-void generate_schedule_from_plaintext(const char *plaintext, KeccakSchedule *schedule);
-
-// Generate complete Keccak schedule from binary data
-void generate_schedule_from_binary(const uint8_t *data, size_t data_len, KeccakSchedule *schedule);
-
-// Generate complete Keccak schedule from key
-void generate_schedule_from_key(const char *key, KeccakSchedule *schedule);
-
-// Apply SHA3-256 padding to message
-size_t apply_sha3_padding(const uint8_t *message, size_t msg_len, 
-                          uint8_t *padded, size_t max_padded_len);
-
-// Initialize Keccak state from binary message with explicit length
-void init_state_from_message(const uint8_t *message, size_t msg_len, u64 state[25]);
-
-// Initialize Keccak state from plaintext (with padding and absorption)
-void init_state_from_plaintext(const char *plaintext, u64 state[25]);
-
-// Print schedule information
-void print_schedule(const KeccakSchedule *schedule);
-
-// Print round schedule
-void print_round_schedule(int round, const RoundSchedule *rs);
-
-#endif // SEED_GENERATION_H
+#ifndef SEED_GENERATION_H
+#define SEED_GENERATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef KECCAK_U64_DEFINED
+#define KECCAK_U64_DEFINED
+typedef uint64_t u64;
+#endif
+
+// Domain separators for seed generation
+#define DOMAIN_SEPARATOR_MSG "KECCAK_VARIANT_MSG_PSJ"
+#define DOMAIN_SEPARATOR_KEY "KECCAK_VARIANT_KEY_PSJ"
+#define DOMAIN_SEPARATOR_NONCE "KECCAK_VARIANT_NONCE_PSJ"
+
+// Schedule mode
+typedef enum {
+    MODE_PLAINTEXT,      // Schedule derived from plaintext
+    MODE_KEY,            // Schedule derived from key
+    MODE_KEY_NONCE       // Schedule derived from key + per-message nonce/header
+} ScheduleMode;
+
+// Variant schedule for one round (4 steps)
+typedef struct {
+    int step_order[4];   // Order of steps: 0=THETA, 1=RHOPI, 2=CHI, 3=IOTA
+    int variants[4];     // Variant number (0-6) for each step
+} RoundSchedule;
+
+// Round counts: the full Keccak-f[1600] permutation, and the reduced-round
+// profile of TurboSHAKE / KangarooTwelve (Keccak-p[1600, 12])
+#define KECCAK_ROUNDS_FULL 24
+#define KECCAK_ROUNDS_FAST 12
+
+// Complete schedule. Only rounds[0 .. num_rounds) are used. Like
+// Keccak-p[1600, n], an n-round permutation runs the last n rounds of the
+// full one: round r takes iota constant KECCAK_ROUNDS_FULL - n + r.
+typedef struct {
+    RoundSchedule rounds[KECCAK_ROUNDS_FULL];
+    int num_rounds;      // 1..KECCAK_ROUNDS_FULL, set to 24 by the generators
+    ScheduleMode mode;
+    uint8_t seed[32];    // SHA-256 seed used
+} KeccakSchedule;
+
+// AES-256-CTR PRNG state
+typedef struct {
+    uint8_t key[32];
+    uint8_t counter[16];
+    uint8_t keystream[16];
+    int pos;
+    uint32_t expanded_key[60];  // Expanded key for AES-256 (14 rounds)
+} AES_CTR_PRNG;
+
+// Incremental SHA-256 state. Full blocks are compressed straight from the
+// input; only a trailing partial block is buffered.
+typedef struct {
+    uint32_t H[8];
+    uint8_t block[64];
+    size_t block_len;    // bytes buffered in block
+    uint64_t total_len;  // bytes absorbed so far
+} SHA256_CTX;
+
+// SHA-256 round constants (shared with the multi-buffer kernels)
+extern const uint32_t SHA256_K[64];
+
+// SHA-256 midstates with DOMAIN_SEPARATOR_MSG / DOMAIN_SEPARATOR_KEY /
+// DOMAIN_SEPARATOR_NONCE already absorbed; copy one to start a seed derivation
+extern const SHA256_CTX SHA256_MIDSTATE_MSG;
+extern const SHA256_CTX SHA256_MIDSTATE_KEY;
+extern const SHA256_CTX SHA256_MIDSTATE_NONCE;
+
+// Streaming SHA-256 (no heap allocation). Full blocks run on the SHA
+// extensions when the CPU has them (checked at run time).
+void sha256_init(SHA256_CTX *ctx);
+void sha256_update(SHA256_CTX *ctx, const uint8_t *input, size_t len);
+void sha256_final(SHA256_CTX *ctx, uint8_t output[32]);
+
+// 1 if the single-stream path runs on the SHA extensions on this CPU
+int sha256_has_shani(void);
+
+// SHA-256 hash function
+void sha256(const uint8_t *input, size_t len, uint8_t output[32]);
+
+// SHA-256 with string input
+void sha256_string(const char *input, uint8_t output[32]);
+
+// Initialize AES-256-CTR PRNG with seed
+void aes_ctr_init(AES_CTR_PRNG *prng, const uint8_t seed[32]);
+
+// Get next 64-bit random value (next 8 keystream bytes, little-endian)
+uint64_t aes_ctr_next(AES_CTR_PRNG *prng);
+
+// Fill out with the next len keystream bytes, the same stream aes_ctr_next
+// reads from. Whole blocks are generated in bulk on AES-NI/VAES when the
+// CPU has them, otherwise on a constant-time bitsliced implementation.
+void aes_ctr_fill(AES_CTR_PRNG *prng, uint8_t *out, size_t len);
+
+// Generate schedule from seed (internal, exposed for testing)
+void generate_schedule_internal(const uint8_t seed[32], KeccakSchedule *schedule);
+
+// Generate schedule from a SHA-256 context started from SHA256_MIDSTATE_MSG
+// or SHA256_MIDSTATE_KEY (or sha256_start_key_nonce), after the message,
+// key or nonce has been streamed in
+void generate_schedule_from_sha256(SHA256_CTX *ctx, ScheduleMode mode, KeccakSchedule *schedule);
+
+// Generate complete Keccak schedule from plaintext (string)
+void generate_schedule_from_plaintext(const char *plaintext, KeccakSchedule *schedule);
+
+// Generate complete Keccak schedule from binary data
+void generate_schedule_from_binary(const uint8_t *data, size_t data_len, KeccakSchedule *schedule);
+
+// Generate complete Keccak schedule from key
+void generate_schedule_from_key(const char *key, KeccakSchedule *schedule);
+
+// MODE_KEY_NONCE: seed = SHA256(DOMAIN_SEPARATOR_NONCE || le64(|key|) || key
+// || nonce). Everything the schedule depends on is known before the message,
+// so the sponge can absorb it from its first byte as it arrives (one pass,
+// nothing buffered), while each message still gets its own schedule. The
+// nonce is any per-message value or header: a counter, a random value, a
+// stream ID. Reusing one under the same key reuses the schedule.
+void generate_schedule_from_key_nonce(const char *key, const uint8_t *nonce, size_t nonce_len,
+                                      KeccakSchedule *schedule);
+
+// The key part of a MODE_KEY_NONCE derivation, for many messages under one
+// key: start ctx once, then per message copy it, sha256_update the nonce and
+// finish with generate_schedule_from_sha256(&copy, MODE_KEY_NONCE, ...).
+void sha256_start_key_nonce(SHA256_CTX *ctx, const char *key);
+
+// Reduce a generated schedule to its first num_rounds rounds (e.g.
+// KECCAK_ROUNDS_FAST); the round constants shift to the last num_rounds
+// positions. Returns 0, or -1 if num_rounds is out of range or larger than
+// the schedule's current count.
+int schedule_set_rounds(KeccakSchedule *schedule, int num_rounds);
+
+// Apply SHA3-256 padding to message
+size_t apply_sha3_padding(const uint8_t *message, size_t msg_len, 
+                          uint8_t *padded, size_t max_padded_len);
+
+// Initialize Keccak state from binary message with explicit length.
+// Absorbs a single rate block only; use keccak_sponge.h for longer messages.
+void init_state_from_message(const uint8_t *message, size_t msg_len, u64 state[25]);
+
+// Initialize Keccak state from plaintext (with padding and absorption)
+void init_state_from_plaintext(const char *plaintext, u64 state[25]);
+
+// Print schedule information
+void print_schedule(const KeccakSchedule *schedule);
+
+// Print schedule as an X-macro for keccak_static.h
+void print_schedule_static(const KeccakSchedule *schedule, const char *name);
+
+// Print round schedule
+void print_round_schedule(int round, const RoundSchedule *rs);
+
+#endif // SEED_GENERATION_H